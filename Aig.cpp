@@ -0,0 +1,168 @@
+#include "Aig.h"
+
+#include <algorithm>
+#include <cassert>
+
+aigLit_t AigData::add_input()
+{
+    assert(m_ands.empty());
+    m_numInputs++;
+    return aig_lit(m_numInputs, false);
+}
+
+aigLit_t AigData::add_and(aigLit_t a, aigLit_t b)
+{
+    if (a > b) { std::swap(a, b); }
+
+    // Constant and trivial cases never need a record.
+    if (a == aigFalse_t) { return aigFalse_t; }
+    if (a == aigTrue_t) { return b; }
+    if (a == b) { return a; }
+    if (a == aig_not(b)) { return aigFalse_t; }
+
+    uint64_t key = (uint64_t(a) << 32) | b;
+    auto found = m_strash.find(key);
+    if (found != m_strash.end()) { return found->second; }
+
+    aigLit_t lit = aig_lit(num_vars(), false);
+    m_ands.push_back(AigAnd{a, b});
+    m_strash.emplace(key, lit);
+    return lit;
+}
+
+AigData SysAig::extract(CircuitData& rData)
+{
+    enum : uint8_t { eUnvisited, eOnStack, eDone };
+
+    size_t numEdges = rData.m_edges.size();
+    std::vector<const ANDGate*> gateOf(numEdges, nullptr);
+    std::vector<int8_t> constOf(numEdges, -1);
+
+    for (auto& node : rData.m_nodes)
+    {
+        if (auto* pGate = dynamic_cast<const ANDGate*>(node.get()))
+        {
+            if (pGate->m_output.m_id != nullEdge_t) { gateOf[pGate->m_output.m_id] = pGate; }
+        }
+        else if (auto* pConst = dynamic_cast<const Constant*>(node.get()))
+        {
+            if (pConst->m_output.m_id != nullEdge_t) { constOf[pConst->m_output.m_id] = pConst->m_state; }
+        }
+    }
+
+    // Order the gates so that every gate comes after the gates driving it, and find the wires that
+    // close combinational loops. Iterative, so deep gate chains don't overflow the stack.
+    std::vector<uint8_t> state(numEdges, eUnvisited);
+    std::vector<bool> isCut(numEdges, false);
+    std::vector<edgeID_t> order;
+    std::vector<std::pair<edgeID_t, int>> stack;
+
+    for (edgeID_t root = 0; root < numEdges; root++)
+    {
+        if (gateOf[root] == nullptr || state[root] != eUnvisited) { continue; }
+
+        stack.emplace_back(root, 0);
+        state[root] = eOnStack;
+        while (!stack.empty())
+        {
+            auto& [wire, child] = stack.back();
+            if (child == 2)
+            {
+                state[wire] = eDone;
+                order.push_back(wire);
+                stack.pop_back();
+                continue;
+            }
+
+            const ANDGate* pGate = gateOf[wire];
+            edgeID_t in = (child++ == 0) ? pGate->m_inA.m_id : pGate->m_inB.m_id;
+            if (gateOf[in] == nullptr) { continue; }
+            if (state[in] == eOnStack) { isCut[in] = true; }
+            else if (state[in] == eUnvisited)
+            {
+                state[in] = eOnStack;
+                stack.emplace_back(in, 0);
+            }
+        }
+    }
+
+    AigData aig;
+    std::vector<aigLit_t> litOf(numEdges, aigFalse_t);
+
+    // Primary inputs: loop cuts, and wires read by a gate that no gate or constant drives.
+    auto make_input = [&](edgeID_t wire)
+    {
+        litOf[wire] = aig.add_input();
+        aig.m_inputWires.push_back(wire);
+    };
+    for (edgeID_t wire : order)
+    {
+        if (isCut[wire]) { make_input(wire); }
+    }
+    std::vector<bool> seen(numEdges, false);
+    for (edgeID_t wire : order)
+    {
+        for (edgeID_t in : {gateOf[wire]->m_inA.m_id, gateOf[wire]->m_inB.m_id})
+        {
+            if (in == nullEdge_t || gateOf[in] != nullptr || seen[in]) { continue; }
+            seen[in] = true;
+            if (constOf[in] >= 0) { litOf[in] = constOf[in] ? aigTrue_t : aigFalse_t; }
+            else { make_input(in); }
+        }
+    }
+
+    // Cut wires keep their input literal for readers; the gate driving them still gets a record.
+    for (edgeID_t wire : order)
+    {
+        const ANDGate* pGate = gateOf[wire];
+        aigLit_t lit = aig.add_and(litOf[pGate->m_inA.m_id], litOf[pGate->m_inB.m_id]);
+        aig.m_outputs.push_back(lit);
+        aig.m_outputWires.push_back(wire);
+        if (!isCut[wire]) { litOf[wire] = lit; }
+    }
+
+    aig.m_values.assign(aig.num_vars(), 0);
+    return aig;
+}
+
+AigData SysAig::absorb(CircuitData& rData)
+{
+    AigData aig = extract(rData);
+    for (auto& node : rData.m_nodes)
+    {
+        if (dynamic_cast<const ANDGate*>(node.get())) { node.reset(); }
+    }
+    return aig;
+}
+
+void SysAig::simulate(AigData& rAig, const uint64_t* pInputs)
+{
+    rAig.m_values.resize(rAig.num_vars());
+    uint64_t* pValues = rAig.m_values.data();
+
+    pValues[0] = 0;
+    std::copy(pInputs, pInputs + rAig.m_numInputs, pValues + 1);
+
+    uint64_t* pOut = pValues + 1 + rAig.m_numInputs;
+    for (const AigAnd& gate : rAig.m_ands)
+    {
+        *pOut++ = lit_value(rAig, gate.m_inA) & lit_value(rAig, gate.m_inB);
+    }
+}
+
+void SysAig::evaluate(AigData& rAig, CircuitData& rData)
+{
+    std::vector<uint64_t> inputs(rAig.m_numInputs);
+    for (uint32_t i = 0; i < rAig.m_numInputs; i++)
+    {
+        bool value = static_cast<WireNode<bool>&>(*rData.m_edges[rAig.m_inputWires[i]]).m_value;
+        inputs[i] = value ? ~uint64_t(0) : uint64_t(0);
+    }
+
+    simulate(rAig, inputs.data());
+
+    for (size_t i = 0; i < rAig.m_outputs.size(); i++)
+    {
+        static_cast<WireNode<bool>&>(*rData.m_edges[rAig.m_outputWires[i]]).m_value = (lit_value(rAig, rAig.m_outputs[i]) & 1) != 0;
+    }
+}
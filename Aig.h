@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "Nodes.h"
+
+// AND-INVERTER GRAPH
+
+// A literal is a variable index shifted left by one, low bit set when the edge is complemented.
+// Variable 0 is constant false, so literal 0 is false and literal 1 is true.
+using aigLit_t = uint32_t;
+
+constexpr aigLit_t aigFalse_t = aigLit_t(0);
+constexpr aigLit_t aigTrue_t = aigLit_t(1);
+
+constexpr aigLit_t aig_lit(uint32_t var, bool complemented) { return (var << 1) | aigLit_t(complemented); }
+constexpr uint32_t aig_var(aigLit_t lit) { return lit >> 1; }
+constexpr bool aig_is_compl(aigLit_t lit) { return (lit & 1) != 0; }
+constexpr aigLit_t aig_not(aigLit_t lit) { return lit ^ 1; }
+
+struct AigAnd
+{
+    aigLit_t m_inA;
+    aigLit_t m_inB;
+};
+
+/**
+ * Flat combinational core. Variable 0 is the constant, variables 1..m_numInputs are primary inputs,
+ * and m_ands[i] defines variable 1 + m_numInputs + i. m_ands is kept in topological order, so a
+ * single forward pass evaluates the whole graph.
+ */
+struct AigData
+{
+    uint32_t m_numInputs{0};
+    std::vector<AigAnd> m_ands;
+    std::vector<aigLit_t> m_outputs;
+
+    // Binding back to the circuit: input i samples m_inputWires[i], m_outputs[i] drives m_outputWires[i].
+    std::vector<edgeID_t> m_inputWires;
+    std::vector<edgeID_t> m_outputWires;
+
+    // One 64-bit word per variable, i.e. 64 independent patterns per evaluation.
+    std::vector<uint64_t> m_values;
+
+    // Structural hashing, so identical AND records are only stored once.
+    std::unordered_map<uint64_t, aigLit_t> m_strash;
+
+    uint32_t num_vars() const { return 1 + m_numInputs + uint32_t(m_ands.size()); }
+
+    // Inputs must all be added before the first AND.
+    aigLit_t add_input();
+    aigLit_t add_and(aigLit_t a, aigLit_t b);
+    aigLit_t add_or(aigLit_t a, aigLit_t b) { return aig_not(add_and(aig_not(a), aig_not(b))); }
+};
+
+namespace SysAig
+{
+// Builds an AIG out of the ANDGate and Constant nodes in the circuit. Wires driven by anything else
+// become primary inputs. A combinational loop is cut at the wire that closes it, which is then read
+// as a primary input holding last cycle's value.
+AigData extract(CircuitData& rData);
+
+// Same as extract(), but also removes the absorbed ANDGates from m_nodes so process_all/propagate_all
+// no longer visit them. Call evaluate() after propagate_all to drive their output wires.
+// This changes timing: in the circuit each ANDGate is a one-cycle register, while an absorbed cone
+// is evaluated combinationally, so its outputs settle within the clock that evaluate() runs in.
+// Constant inputs are folded in at extract time; later changes to a Constant's m_state are ignored.
+AigData absorb(CircuitData& rData);
+
+// Evaluates 64 patterns at once. pInputs holds one word per primary input.
+void simulate(AigData& rAig, const uint64_t* pInputs);
+
+// Samples the input wires, evaluates, and writes the output wires.
+void evaluate(AigData& rAig, CircuitData& rData);
+
+inline uint64_t lit_value(const AigData& aig, aigLit_t lit)
+{
+    return aig.m_values[aig_var(lit)] ^ (uint64_t(0) - uint64_t(aig_is_compl(lit)));
+}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "GraphTypes.h"
+
+/**
+ * Free list of payload buffers for one connection. The consumer hands back each buffer it's done with, and the producer
+ * takes its next buffer from here instead of allocating, so a vector or command buffer keeps its capacity from cycle to
+ * cycle. Buffers are clear()ed (if they have a clear()) on the way in, never shrunk.
+ */
+template<typename DATA_T>
+struct BufferPool
+{
+    DATA_T acquire()
+    {
+        if (m_free.empty())
+        {
+            m_created++;
+            return DATA_T{};
+        }
+        m_reused++;
+        DATA_T buffer = std::move(m_free.back());
+        m_free.pop_back();
+        return buffer;
+    }
+
+    void release(DATA_T buffer)
+    {
+        if (m_free.size() >= m_maxFree) { return; }
+        if constexpr (has_clear<DATA_T>::value) { buffer.clear(); }
+        m_free.push_back(std::move(buffer));
+    }
+
+    template<typename T, typename = void>
+    struct has_clear : std::false_type {};
+    template<typename T>
+    struct has_clear<T, std::void_t<decltype(std::declval<T&>().clear())>> : std::true_type {};
+
+    std::vector<DATA_T> m_free;
+    size_t m_maxFree{16};
+
+    size_t m_created{0};
+    size_t m_reused{0};
+};
+
+/**
+ * MemberOutput whose buffer comes from a pool. The producer fills buffer() each cycle; return_output() moves it out as
+ * usual, and the next buffer() call fetches a recycled one.
+ */
+template<typename DATA_T>
+struct PooledMemberOutput : StaticOutput<PooledMemberOutput<DATA_T>, DATA_T>
+{
+    DATA_T& buffer()
+    {
+        if (!m_hasBuffer)
+        {
+            m_buffer = m_pPool ? m_pPool->acquire() : DATA_T{};
+            m_hasBuffer = true;
+        }
+        return m_buffer;
+    }
+
+    DATA_T on_output()
+    {
+        buffer();
+        m_hasBuffer = false;
+        return std::move(m_buffer);
+    }
+
+    DATA_T m_buffer{};
+    bool m_hasBuffer{false};
+    std::shared_ptr<BufferPool<DATA_T>> m_pPool;
+};
+
+/**
+ * BufferedMemberInput that returns the buffer it's holding to the pool when the next one arrives, or earlier if the
+ * parent calls release() once it's done with it.
+ */
+template<typename DATA_T, typename PARENT_T, void (PARENT_T::*POINTER_TO_MEMBER)(DATA_T)>
+struct PooledBufferedMemberInput : StaticInput<PooledBufferedMemberInput<DATA_T, PARENT_T, POINTER_TO_MEMBER>, DATA_T>
+{
+    void on_input(DATA_T t)
+    {
+        release();
+        m_buffer = std::move(t);
+        m_hasBuffer = true;
+    }
+
+    void release()
+    {
+        if (m_hasBuffer && m_pPool) { m_pPool->release(std::move(m_buffer)); }
+        m_hasBuffer = false;
+    }
+
+    DATA_T m_buffer{};
+    bool m_hasBuffer{false};
+    std::shared_ptr<BufferPool<DATA_T>> m_pPool;
+};
+
+/**
+ * UniDirectionalConnection that owns the pool shared by its two ends.
+ */
+template<typename SOURCE, typename SINK>
+struct PooledConnection : IConnection
+{
+    using data_type = typename SOURCE::output_type;
+
+    PooledConnection(std::shared_ptr<SOURCE> src, std::shared_ptr<SINK> sink)
+        : source(src), sink(sink), pool(std::make_shared<BufferPool<data_type>>())
+    {
+        source->m_pPool = pool;
+        sink->m_pPool = pool;
+    }
+
+    void distribute() override final
+    {
+        sink->accept_input(source->return_output());
+    }
+
+    std::shared_ptr<SOURCE> source;
+    std::shared_ptr<SINK> sink;
+    std::shared_ptr<BufferPool<data_type>> pool;
+};
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+
+// Cache line size assumed for padding and alignment. Header of its own so that both the push-model types
+// (GraphTypes.h) and the circuit types (Nodes.h) can use it; the two can't be included together.
+constexpr size_t lineSize_t = 64;
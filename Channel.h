@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "CacheLine.h"
+#include "GraphTypes.h"
+
+struct ChannelStats
+{
+    uint64_t m_pushed{0};
+    uint64_t m_popped{0};
+    uint64_t m_fullRejects{0};   // items the producer offered while the ring was full
+    uint64_t m_emptyPolls{0};    // pops attempted while the ring was empty
+    size_t m_highWater{0};       // highest occupancy seen by the producer; an upper bound, see push_bulk
+};
+
+/**
+ * Bounded single-producer single-consumer ring. ready() is the producer's "there is room", valid() the consumer's
+ * "there is data"; nothing is ever overwritten, a full ring just refuses the push. One thread may push while another
+ * pops, with no locks: each side owns one index and keeps a cached copy of the other's, so the shared cache lines are
+ * only touched when the cached view runs out.
+ * CAPACITY must be a power of two.
+ */
+template<typename DATA_T, size_t CAPACITY>
+struct SpscChannel
+{
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    // PRODUCER
+
+    bool ready()
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        return tail - consumer_index() < CAPACITY;
+    }
+
+    // The item is only moved from once a slot is secured, so a false return leaves it intact for a retry.
+    bool try_push(DATA_T&& item) { return push_one(std::move(item)); }
+    bool try_push(const DATA_T& item) { return push_one(item); }
+
+    // Moves up to count items in, returns how many fitted.
+    size_t push_bulk(DATA_T* pItems, size_t count)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t space = CAPACITY - (tail - m_cachedHead);
+        if (space < count)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            space = CAPACITY - (tail - m_cachedHead);
+        }
+
+        size_t n = (count < space) ? count : space;
+        for (size_t i = 0; i < n; i++) { m_slots[(tail + i) & (CAPACITY - 1)] = std::move(pItems[i]); }
+        m_tail.store(tail + n, std::memory_order_release);
+
+        bump(m_pushed, n);
+        bump(m_fullRejects, count - n);
+        // Measured against the producer's cached head, which may lag the consumer, so it can overstate occupancy.
+        // Reloading the head here would cost a shared cache line on every push.
+        size_t occupancy = tail + n - m_cachedHead;
+        if (occupancy > m_highWater.load(std::memory_order_relaxed)) { m_highWater.store(occupancy, std::memory_order_relaxed); }
+        return n;
+    }
+
+    template<typename ITEM_T>
+    bool push_one(ITEM_T&& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead >= CAPACITY)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead >= CAPACITY)
+            {
+                bump(m_fullRejects, 1);
+                return false;
+            }
+        }
+
+        m_slots[tail & (CAPACITY - 1)] = std::forward<ITEM_T>(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        bump(m_pushed, 1);
+        // Upper bound, as in push_bulk.
+        size_t occupancy = tail + 1 - m_cachedHead;
+        if (occupancy > m_highWater.load(std::memory_order_relaxed)) { m_highWater.store(occupancy, std::memory_order_relaxed); }
+        return true;
+    }
+
+    // CONSUMER
+
+    bool valid()
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        return producer_index() != head;
+    }
+
+    bool try_pop(DATA_T& rItem) { return pop_bulk(&rItem, 1) == 1; }
+
+    // Moves up to max items out, returns how many there were.
+    size_t pop_bulk(DATA_T* pOut, size_t max)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t available = m_cachedTail - head;
+        if (available < max)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            available = m_cachedTail - head;
+        }
+
+        size_t n = (max < available) ? max : available;
+        for (size_t i = 0; i < n; i++) { pOut[i] = std::move(m_slots[(head + i) & (CAPACITY - 1)]); }
+        m_head.store(head + n, std::memory_order_release);
+
+        bump(m_popped, n);
+        if (n == 0) { bump(m_emptyPolls, 1); }
+        return n;
+    }
+
+    // EITHER SIDE
+
+    // Approximate when called while the other side is running.
+    size_t occupancy() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    ChannelStats stats() const
+    {
+        ChannelStats out;
+        out.m_pushed = m_pushed.load(std::memory_order_relaxed);
+        out.m_popped = m_popped.load(std::memory_order_relaxed);
+        out.m_fullRejects = m_fullRejects.load(std::memory_order_relaxed);
+        out.m_emptyPolls = m_emptyPolls.load(std::memory_order_relaxed);
+        out.m_highWater = m_highWater.load(std::memory_order_relaxed);
+        return out;
+    }
+
+    size_t consumer_index()
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead >= CAPACITY) { m_cachedHead = m_head.load(std::memory_order_acquire); }
+        return m_cachedHead;
+    }
+
+    size_t producer_index()
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cachedTail == head) { m_cachedTail = m_tail.load(std::memory_order_acquire); }
+        return m_cachedTail;
+    }
+
+    // Counters are only written by the side that owns them, so a relaxed load/store pair is enough.
+    static void bump(std::atomic<uint64_t>& rCounter, uint64_t n)
+    {
+        if (n) { rCounter.store(rCounter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    }
+
+    // Consumer-owned
+    alignas(lineSize_t) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail{0};
+    std::atomic<uint64_t> m_popped{0};
+    std::atomic<uint64_t> m_emptyPolls{0};
+
+    // Producer-owned
+    alignas(lineSize_t) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead{0};
+    std::atomic<uint64_t> m_pushed{0};
+    std::atomic<uint64_t> m_fullRejects{0};
+    std::atomic<size_t> m_highWater{0};
+
+    alignas(lineSize_t) std::array<DATA_T, CAPACITY> m_slots{};
+};
+
+/**
+ * Connection backed by an SpscChannel instead of a single slot. The producer pushes into channel directly (from any one
+ * thread, as many items per call as it likes); distribute(), on the consumer's thread, drains up to m_maxPerDistribute
+ * items into the sink in order. Nothing is dropped: when the ring is full the producer sees ready() == false.
+ */
+template<typename DATA_T, size_t CAPACITY, typename SINK_T>
+struct ChannelConnection : IConnection
+{
+    ChannelConnection(std::shared_ptr<SINK_T> sink, size_t maxPerDistribute = CAPACITY)
+        : sink(sink), m_maxPerDistribute(maxPerDistribute)
+    {}
+
+    void distribute() override final
+    {
+        constexpr size_t c_batch = 32;
+        DATA_T batch[c_batch];
+
+        size_t remaining = m_maxPerDistribute;
+        while (remaining > 0)
+        {
+            size_t n = channel.pop_bulk(batch, remaining < c_batch ? remaining : c_batch);
+            for (size_t i = 0; i < n; i++) { sink->accept_input(std::move(batch[i])); }
+            if (n < c_batch) { break; }
+            remaining -= n;
+        }
+    }
+
+    SpscChannel<DATA_T, CAPACITY> channel;
+    std::shared_ptr<SINK_T> sink;
+    size_t m_maxPerDistribute;
+};
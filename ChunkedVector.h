@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * Growable array stored in fixed chunks of 2^CHUNK_SHIFT elements. Growing adds a chunk and never moves what's
+ * already there, so push_back costs the same at ten elements or ten million, and references to elements stay valid
+ * until the element is removed by resize(). Indexing is one extra load compared to std::vector.
+ */
+template <typename T, size_t CHUNK_SHIFT = 12>
+struct ChunkedVector
+{
+    static constexpr size_t chunkSize = size_t(1) << CHUNK_SHIFT;
+    static constexpr size_t chunkMask = chunkSize - 1;
+
+    template <typename VECTOR_T, typename VALUE_T>
+    struct Iterator
+    {
+        VALUE_T& operator*() const { return (*m_pVector)[m_index]; }
+        VALUE_T* operator->() const { return &(*m_pVector)[m_index]; }
+        Iterator& operator++()
+        {
+            m_index++;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+        VECTOR_T* m_pVector;
+        size_t m_index;
+    };
+    using iterator = Iterator<ChunkedVector, T>;
+    using const_iterator = Iterator<const ChunkedVector, const T>;
+
+    ChunkedVector() = default;
+    ChunkedVector(std::initializer_list<T> values)
+    {
+        for (const T& value : values) { push_back(value); }
+    }
+
+    // Copies are element-wise into freshly allocated chunks, sized to fit.
+    ChunkedVector(const ChunkedVector& other)
+    {
+        reserve(other.m_size);
+        for (size_t i = 0; i < other.m_size; i++) { (*this)[i] = other[i]; }
+        m_size = other.m_size;
+    }
+    ChunkedVector& operator=(const ChunkedVector& other)
+    {
+        if (this != &other) { *this = ChunkedVector(other); }
+        return *this;
+    }
+    // Moves take the chunks and leave other empty.
+    ChunkedVector(ChunkedVector&& other) noexcept : m_chunks(std::move(other.m_chunks)), m_size(other.m_size)
+    {
+        other.m_chunks.clear();
+        other.m_size = 0;
+    }
+    ChunkedVector& operator=(ChunkedVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            m_chunks = std::move(other.m_chunks);
+            m_size = other.m_size;
+            other.m_chunks.clear();
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    T& operator[](size_t index) { return m_chunks[index >> CHUNK_SHIFT][index & chunkMask]; }
+    const T& operator[](size_t index) const { return m_chunks[index >> CHUNK_SHIFT][index & chunkMask]; }
+
+    T& at(size_t index)
+    {
+        if (index >= m_size) { throw std::out_of_range("ChunkedVector::at"); }
+        return (*this)[index];
+    }
+    const T& at(size_t index) const
+    {
+        if (index >= m_size) { throw std::out_of_range("ChunkedVector::at"); }
+        return (*this)[index];
+    }
+
+    T& back() { return (*this)[m_size - 1]; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_chunks.size() * chunkSize; }
+
+    template <typename ... ARGS_T>
+    T& emplace_back(ARGS_T&& ...args)
+    {
+        if (m_size == capacity()) { m_chunks.push_back(std::make_unique<T[]>(chunkSize)); }
+        T& rSlot = (*this)[m_size++];
+        rSlot = T(std::forward<ARGS_T>(args)...);
+        return rSlot;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    // Makes room for at least count elements in total, so that growing up to there allocates nothing.
+    void reserve(size_t count)
+    {
+        while (capacity() < count) { m_chunks.push_back(std::make_unique<T[]>(chunkSize)); }
+    }
+
+    // Growing fills with T{}. Shrinking resets the removed elements to T{}, but keeps the chunks for reuse.
+    void resize(size_t count)
+    {
+        reserve(count);
+        for (size_t i = count; i < m_size; i++) { (*this)[i] = T{}; }
+        m_size = count;
+    }
+
+    // Frees the chunks past the last element.
+    void shrink_to_fit() { m_chunks.resize((m_size + chunkMask) >> CHUNK_SHIFT); }
+
+    iterator begin() { return iterator{this, 0}; }
+    iterator end() { return iterator{this, m_size}; }
+    const_iterator begin() const { return const_iterator{this, 0}; }
+    const_iterator end() const { return const_iterator{this, m_size}; }
+
+    std::vector<std::unique_ptr<T[]>> m_chunks;
+    size_t m_size{0};
+};
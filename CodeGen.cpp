@@ -0,0 +1,147 @@
+#include "CodeGen.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include <dlfcn.h>
+
+namespace
+{
+
+bool is_identifier(const std::string& name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) { return false; }
+    for (char c : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') { return false; }
+    }
+    return true;
+}
+
+// Single-quoted for /bin/sh, with embedded quotes spelled '\''.
+std::string shell_quote(const std::string& arg)
+{
+    std::string out = "'";
+    for (char c : arg)
+    {
+        if (c == '\'') { out += "'\\''"; }
+        else { out += c; }
+    }
+    return out + "'";
+}
+
+} // namespace
+
+bool SysCodeGen::emit(CircuitData& rData, std::ostream& rOut, const std::string& name)
+{
+    if (!is_identifier(name))
+    {
+        std::cerr << "SysCodeGen: '" << name << "' isn't a valid C identifier\n";
+        return false;
+    }
+
+    CodeWriter writer(rData);
+    for (nodeID_t id = 0; id < rData.m_nodes.size(); id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+
+        writer.m_node = id;
+        if (!rData.m_nodes[id]->generate(writer))
+        {
+            std::cerr << "SysCodeGen: node " << id << " can't be exported\n";
+            return false;
+        }
+    }
+    if (!writer.m_ok)
+    {
+        std::cerr << "SysCodeGen: circuit uses a type with no cpp_type<> spelling\n";
+        return false;
+    }
+
+    std::string state = name + "_state";
+    rOut << "// Generated by SysCodeGen::emit. Do not edit.\n"
+         << "#include <cstdint>\n"
+         << "#include <iostream>\n\n"
+         << "struct " << state << "\n{\n" << writer.m_fields.str() << "};\n\n"
+         << writer.m_tables.str() << "\n"
+         << "static inline void " << name << "_step(" << state << "& s)\n{\n"
+         << writer.m_process.str() << "\n" << writer.m_propagate.str() << "}\n\n"
+         << "extern \"C\" void* " << name << "_create() { return new " << state << "; }\n"
+         << "extern \"C\" void " << name << "_destroy(void* p) { delete static_cast<" << state << "*>(p); }\n"
+         << "extern \"C\" void " << name << "_cycle(void* p) { " << name << "_step(*static_cast<" << state << "*>(p)); }\n"
+         << "extern \"C\" void " << name << "_run(void* p, uint64_t cycles)\n{\n"
+         << "    " << state << "& s = *static_cast<" << state << "*>(p);\n"
+         << "    for (uint64_t clk = 0; clk < cycles; clk++) { " << name << "_step(s); }\n"
+         << "}\n";
+    return true;
+}
+
+CompiledCircuit::CompiledCircuit(CompiledCircuit&& other) noexcept
+    : m_pHandle(other.m_pHandle), m_pState(other.m_pState), m_cycle(other.m_cycle), m_run(other.m_run),
+      m_destroy(other.m_destroy)
+{
+    other.m_pHandle = nullptr;
+    other.m_pState = nullptr;
+}
+
+CompiledCircuit& CompiledCircuit::operator=(CompiledCircuit&& other) noexcept
+{
+    // other's destructor releases whatever this held.
+    std::swap(m_pHandle, other.m_pHandle);
+    std::swap(m_pState, other.m_pState);
+    std::swap(m_cycle, other.m_cycle);
+    std::swap(m_run, other.m_run);
+    std::swap(m_destroy, other.m_destroy);
+    return *this;
+}
+
+CompiledCircuit::~CompiledCircuit()
+{
+    if (m_pState) { m_destroy(m_pState); }
+    if (m_pHandle) { dlclose(m_pHandle); }
+}
+
+std::unique_ptr<CompiledCircuit> SysCodeGen::compile(CircuitData& rData, const std::string& name, const std::string& dir)
+{
+    if (!is_identifier(name))
+    {
+        std::cerr << "SysCodeGen: '" << name << "' isn't a valid C identifier\n";
+        return nullptr;
+    }
+
+    std::string source = dir + "/" + name + ".cpp";
+    std::string library = dir + "/lib" + name + ".so";
+    {
+        std::ofstream file(source);
+        if (!file || !emit(rData, file, name)) { return nullptr; }
+    }
+
+    const char* compiler = std::getenv("CXX");
+    std::string command = std::string(compiler ? compiler : "c++")
+        + " -std=c++17 -O2 -shared -fPIC -o " + shell_quote(library) + " " + shell_quote(source);
+    if (std::system(command.c_str()) != 0)
+    {
+        std::cerr << "SysCodeGen: '" << command << "' failed\n";
+        return nullptr;
+    }
+
+    auto compiled = std::make_unique<CompiledCircuit>();
+    compiled->m_pHandle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!compiled->m_pHandle)
+    {
+        std::cerr << "SysCodeGen: " << dlerror() << "\n";
+        return nullptr;
+    }
+
+    auto create = reinterpret_cast<void* (*)()>(dlsym(compiled->m_pHandle, (name + "_create").c_str()));
+    compiled->m_destroy = reinterpret_cast<void (*)(void*)>(dlsym(compiled->m_pHandle, (name + "_destroy").c_str()));
+    compiled->m_cycle = reinterpret_cast<void (*)(void*)>(dlsym(compiled->m_pHandle, (name + "_cycle").c_str()));
+    compiled->m_run = reinterpret_cast<void (*)(void*, uint64_t)>(dlsym(compiled->m_pHandle, (name + "_run").c_str()));
+    if (!create || !compiled->m_destroy || !compiled->m_cycle || !compiled->m_run) { return nullptr; }
+
+    compiled->m_pState = create();
+    return compiled;
+}
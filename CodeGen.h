@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Nodes.h"
+
+// AHEAD-OF-TIME CODE GENERATION
+
+template <typename T>
+std::string cpp_literal(const T& value)
+{
+    // -9223372036854775808 is unary minus on a literal too big for any signed type.
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+        if (value == std::numeric_limits<T>::min()) { return "(" + std::to_string(value + 1) + " - 1)"; }
+    }
+    std::ostringstream out;
+    out << +value;
+    // Values of 2^63 and up don't fit any signed type, so unsigned 64-bit literals always carry the suffix.
+    if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 8) { out << "ull"; }
+    return out.str();
+}
+
+/**
+ * Handed to Node::generate for each node in turn. Wires become fields of the generated state struct,
+ * initialised with their current value, and node state likewise. Process and propagate lines go into
+ * the two halves of the generated cycle function, in m_nodes order.
+ */
+struct CodeWriter
+{
+    CodeWriter(CircuitData& rData) : m_rData(rData) {}
+
+    // Expression naming the wire's storage in generated code.
+    template <typename DATA_T>
+    std::string wire(NodeTerminal<WireNode<DATA_T>>& rTerminal)
+    {
+        const char* type = cpp_type<DATA_T>();
+        if (type == nullptr || rTerminal.m_id == nullEdge_t) { return declare_wire(rTerminal.m_id, type, "{}"); }
+        return declare_wire(rTerminal.m_id, type, cpp_literal(rTerminal.get(m_rData).m_value));
+    }
+
+    // Same for callers that only have the type's cpp_type<> spelling; the initial value is read through
+    // Connection::pack.
+    std::string wire(edgeID_t id, const char* type);
+
+    // Expression naming a field of this node's state.
+    template <typename DATA_T>
+    std::string state(const char* field, const DATA_T& value)
+    {
+        return declare_state(field, cpp_type<DATA_T>(), cpp_literal(value));
+    }
+
+    std::string declare_wire(edgeID_t id, const char* type, const std::string& init);
+    std::string declare_state(const char* field, const char* type, const std::string& init);
+    std::string declare_table(const char* field, const char* type, const std::string& values);
+
+    void process(const std::string& line) { m_process << "    " << line << "\n"; }
+    void propagate(const std::string& line) { m_propagate << "    " << line << "\n"; }
+
+    CircuitData& m_rData;
+    nodeID_t m_node{nullNode_t};
+    bool m_ok{true};
+
+    std::vector<const char*> m_wireTypes;
+    std::ostringstream m_fields;
+    std::ostringstream m_tables;
+    std::ostringstream m_process;
+    std::ostringstream m_propagate;
+};
+
+/**
+ * A circuit exported by SysCodeGen::emit and loaded back as a shared object. Owns the dlopen handle
+ * and one instance of the generated state struct.
+ */
+struct CompiledCircuit
+{
+    CompiledCircuit() = default;
+    CompiledCircuit(const CompiledCircuit&) = delete;
+    CompiledCircuit& operator=(const CompiledCircuit&) = delete;
+    CompiledCircuit(CompiledCircuit&& other) noexcept;
+    CompiledCircuit& operator=(CompiledCircuit&& other) noexcept;
+    ~CompiledCircuit();
+
+    void cycle() { m_cycle(m_pState); }
+    void run(uint64_t cycles) { m_run(m_pState, cycles); }
+
+    void* m_pHandle{nullptr};
+    void* m_pState{nullptr};
+    void (*m_cycle)(void*){nullptr};
+    void (*m_run)(void*, uint64_t){nullptr};
+    void (*m_destroy)(void*){nullptr};
+};
+
+namespace SysCodeGen
+{
+// Writes a standalone translation unit with one straight-line function per clock cycle: every wire
+// and every bit of node state is a field of <name>_state, and each cycle runs the process half then
+// the propagate half of every node, in m_nodes order, exactly like process_all + propagate_all.
+// Exported entry points are extern "C":
+//     void* <name>_create();  void <name>_destroy(void*);
+//     void <name>_cycle(void*);  void <name>_run(void*, uint64_t cycles);
+// Returns false if any node doesn't implement Node::generate, or if name isn't a valid C identifier.
+bool emit(CircuitData& rData, std::ostream& rOut, const std::string& name);
+
+// Emits <dir>/<name>.cpp, builds it with $CXX (default c++) as a shared object and loads it with
+// dlopen. dir is passed to the shell quoted; name must be a valid C identifier. Returns nullptr on
+// failure. Link the caller with -ldl.
+std::unique_ptr<CompiledCircuit> compile(CircuitData& rData, const std::string& name, const std::string& dir);
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "GraphTypes.h"
+
+/**
+ * Address a connection delivers into, used to order connections inside a batch so that consecutive distribute() calls
+ * write to neighbouring sinks. Anything with a "sink" member uses that, the two-way connections use their first end.
+ * Other types all get the same key, so their batches keep insertion order. Specialise for connection types that keep
+ * their sink somewhere else.
+ */
+template<typename CONN_T, typename = void>
+struct ConnectionSink
+{
+    static const void* get(const CONN_T&) { return nullptr; }
+};
+
+template<typename CONN_T>
+struct ConnectionSink<CONN_T, std::void_t<decltype(std::declval<const CONN_T&>().sink.get())>>
+{
+    static const void* get(const CONN_T& conn) { return conn.sink.get(); }
+};
+
+template<typename A, typename B>
+struct ConnectionSink<BiDirectionalConnection<A, B>, void>
+{
+    static const void* get(const BiDirectionalConnection<A, B>& conn) { return conn.a.get(); }
+};
+
+template<typename A>
+struct ConnectionSink<ReflectionConnection<A>, void>
+{
+    static const void* get(const ReflectionConnection<A>& conn) { return conn.a.get(); }
+};
+
+/**
+ * All connections of one concrete type, stored by value. distribute_all() calls distribute() qualified with the concrete
+ * type, so the loop body is a direct (and usually inlined) call instead of a virtual one.
+ */
+struct IConnectionBatch
+{
+    virtual ~IConnectionBatch() = default;
+    virtual void distribute_all() = 0;
+    virtual void sort_by_sink() = 0;
+    virtual size_t size() const = 0;
+};
+
+template<typename CONN_T>
+struct ConnectionBatch : IConnectionBatch
+{
+    // Batches store and sort connections by value. ChannelConnection holds atomics and can't be moved, so it can't go
+    // in a batch; keep it behind a pointer and distribute it separately.
+    static_assert(std::is_move_constructible_v<CONN_T> && std::is_move_assignable_v<CONN_T>,
+                  "ConnectionBatch needs a movable connection type");
+
+    void distribute_all() override final
+    {
+        for (CONN_T& conn : m_connections) { conn.CONN_T::distribute(); }
+    }
+
+    void sort_by_sink() override final
+    {
+        std::stable_sort(m_connections.begin(), m_connections.end(), [](const CONN_T& a, const CONN_T& b)
+        {
+            return std::less<const void*>()(ConnectionSink<CONN_T>::get(a), ConnectionSink<CONN_T>::get(b));
+        });
+    }
+
+    size_t size() const override final { return m_connections.size(); }
+
+    std::vector<CONN_T> m_connections;
+};
+
+/**
+ * Replacement for a std::vector of heterogeneous IConnection pointers in the push-model loop. Connections are grouped by
+ * concrete type and, after finalize(), ordered by sink address within each group.
+ * Distribution order is by type, then sink, not insertion order. That's fine as long as no two connections in the same
+ * distribute step feed each other, which is the push model's contract anyway (processing happens between steps).
+ */
+struct ConnectionManager
+{
+    template<typename CONN_T>
+    void add(CONN_T conn)
+    {
+        static_assert(std::is_base_of_v<IConnection, CONN_T>, "ConnectionManager only holds IConnection types");
+        batch<CONN_T>().m_connections.push_back(std::move(conn));
+        m_sorted = false;
+    }
+
+    template<typename CONN_T, typename ... ARGS_T>
+    void emplace(ARGS_T&& ... args)
+    {
+        batch<CONN_T>().m_connections.emplace_back(std::forward<ARGS_T>(args)...);
+        m_sorted = false;
+    }
+
+    // Sorts every batch by sink. Called automatically by the first distribute_all() after an add.
+    void finalize()
+    {
+        for (auto& pBatch : m_batches) { pBatch->sort_by_sink(); }
+        m_sorted = true;
+    }
+
+    void distribute_all()
+    {
+        if (!m_sorted) { finalize(); }
+        for (auto& pBatch : m_batches) { pBatch->distribute_all(); }
+    }
+
+    size_t size() const
+    {
+        size_t total = 0;
+        for (auto& pBatch : m_batches) { total += pBatch->size(); }
+        return total;
+    }
+
+    template<typename CONN_T>
+    ConnectionBatch<CONN_T>& batch()
+    {
+        auto found = m_index.find(std::type_index(typeid(CONN_T)));
+        if (found != m_index.end()) { return static_cast<ConnectionBatch<CONN_T>&>(*found->second); }
+
+        auto pBatch = std::make_unique<ConnectionBatch<CONN_T>>();
+        ConnectionBatch<CONN_T>& rBatch = *pBatch;
+        m_index.emplace(std::type_index(typeid(CONN_T)), pBatch.get());
+        m_batches.push_back(std::move(pBatch));
+        return rBatch;
+    }
+
+    std::vector<std::unique_ptr<IConnectionBatch>> m_batches;
+    std::unordered_map<std::type_index, IConnectionBatch*> m_index;
+    bool m_sorted{true};
+};
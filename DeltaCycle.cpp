@@ -0,0 +1,100 @@
+#include "DeltaCycle.h"
+
+#include <algorithm>
+
+DeltaState SysDelta::prepare(CircuitData& rData, uint32_t maxIterations)
+{
+    DeltaState state;
+    state.m_graph = SysNetlist::build(rData);
+    state.m_maxIterations = maxIterations;
+
+    size_t numNodes = rData.m_nodes.size();
+    state.m_combinational.assign(numNodes, false);
+    state.m_queued.assign(numNodes, false);
+    for (nodeID_t id = 0; id < numNodes; id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        if (rData.m_nodes[id]->combinational()) { state.m_combinational[id] = true; }
+        else { state.m_clocked.push_back(id); }
+    }
+    state.m_snapshot = SysNetlist::snapshot(rData, state.m_graph.m_outputs);
+    return state;
+}
+
+namespace
+{
+
+// Latches the node's output wires and queues the combinational readers of any that changed.
+void queue_fanout(CircuitData& rData, DeltaState& rState, nodeID_t node)
+{
+    const NetlistGraph& graph = rState.m_graph;
+    for (uint32_t i = graph.m_outputStart[node]; i < graph.m_outputStart[node + 1]; i++)
+    {
+        edgeID_t wire = graph.m_outputs[i];
+        if (!SysNetlist::latch(rData, rState.m_snapshot, wire)) { continue; }
+
+        for (uint32_t r = graph.m_readerStart[wire]; r < graph.m_readerStart[wire + 1]; r++)
+        {
+            nodeID_t reader = graph.m_readers[r];
+            if (rState.m_combinational[reader] && !rState.m_queued[reader])
+            {
+                rState.m_queued[reader] = true;
+                rState.m_nextWave.push_back(reader);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool SysDelta::step(CircuitData& rData, DeltaState& rState)
+{
+    rState.m_iterations = 0;
+    rState.m_evaluations = 0;
+
+    for (nodeID_t id : rState.m_clocked) { rData.m_nodes[id]->process(rData); }
+    for (nodeID_t id : rState.m_clocked) { rData.m_nodes[id]->propagate(rData); }
+    for (nodeID_t id : rState.m_clocked) { queue_fanout(rData, rState, id); }
+    if (rState.m_pTrace) { rState.m_pTrace->insert(rState.m_pTrace->end(), rState.m_clocked.begin(), rState.m_clocked.end()); }
+
+    // Nothing has evaluated the combinational nodes yet, so the first clock visits all of them once.
+    if (!rState.m_primed)
+    {
+        for (nodeID_t id = 0; id < rState.m_combinational.size(); id++)
+        {
+            if (rState.m_combinational[id] && !rState.m_queued[id])
+            {
+                rState.m_queued[id] = true;
+                rState.m_nextWave.push_back(id);
+            }
+        }
+        rState.m_primed = true;
+    }
+
+    while (!rState.m_nextWave.empty())
+    {
+        if (rState.m_iterations == std::max(rState.m_maxIterations, 1u))
+        {
+            // The pending wave's inputs have already been latched as changed, so it stays queued for the next step().
+            rState.m_converged = false;
+            return false;
+        }
+        rState.m_iterations++;
+
+        std::swap(rState.m_wave, rState.m_nextWave);
+        for (nodeID_t id : rState.m_wave)
+        {
+            rState.m_queued[id] = false;
+            rData.m_nodes[id]->process(rData);
+        }
+        for (nodeID_t id : rState.m_wave) { rData.m_nodes[id]->propagate(rData); }
+        for (nodeID_t id : rState.m_wave) { queue_fanout(rData, rState, id); }
+        if (rState.m_pTrace) { rState.m_pTrace->insert(rState.m_pTrace->end(), rState.m_wave.begin(), rState.m_wave.end()); }
+
+        rState.m_evaluations += rState.m_wave.size();
+        rState.m_wave.clear();
+    }
+
+    rState.m_converged = true;
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Netlist.h"
+
+// DELTA-CYCLE SETTLING
+
+/**
+ * Clocking where combinational nodes settle within the clock they're driven in. Each step() runs the clocked
+ * (non-combinational) nodes once, like process_all + propagate_all, then evaluates combinational nodes in waves
+ * (delta cycles): a node is only re-evaluated when one of the wires it reads actually changed in the previous wave.
+ * Stops at a fixed point, or after m_maxIterations waves if the logic oscillates; the unfinished wave then carries over
+ * into the next step().
+ * Build with SysDelta::prepare, and prepare again after editing the circuit.
+ */
+struct DeltaState
+{
+    NetlistGraph m_graph;
+    std::vector<nodeID_t> m_clocked;
+    std::vector<bool> m_combinational;
+
+    std::vector<bool> m_queued;
+    std::vector<nodeID_t> m_wave;
+    std::vector<nodeID_t> m_nextWave;
+    WireSnapshot m_snapshot;                        // driven wires, to see which ones an evaluation changed
+    bool m_primed{false};
+
+    uint32_t m_maxIterations{1000};                 // waves per clock; 0 counts as 1
+
+    // If set, every node step() evaluates is appended here, in evaluation order. Used for profiling.
+    std::vector<nodeID_t>* m_pTrace{nullptr};
+
+    // Stats for the last step()
+    uint32_t m_iterations{0};
+    size_t m_evaluations{0};
+    bool m_converged{true};
+};
+
+namespace SysDelta
+{
+DeltaState prepare(CircuitData& rData, uint32_t maxIterations = 1000);
+
+// One clock. Returns false if the combinational logic didn't settle within the iteration limit.
+bool step(CircuitData& rData, DeltaState& rState);
+}
@@ -0,0 +1,203 @@
+#include "Editing.h"
+
+#include <algorithm>
+
+namespace
+{
+
+uint32_t generation(const std::vector<uint32_t>& generations, uint32_t base, uint32_t id)
+{
+    return id < generations.size() ? generations[id] : base;
+}
+
+void retire(std::vector<uint32_t>& rGenerations, CircuitEdits& rEdits, uint32_t id)
+{
+    if (rGenerations.size() <= id) { rGenerations.resize(id + 1, rEdits.m_baseGeneration); }
+    rGenerations[id] = rEdits.m_nextGeneration++;
+}
+
+} // namespace
+
+NodeHandle SysEdit::node_handle(const CircuitEdits& edits, nodeID_t id)
+{
+    return NodeHandle{id, generation(edits.m_nodeGeneration, edits.m_baseGeneration, id)};
+}
+
+WireHandle SysEdit::wire_handle(const CircuitEdits& edits, edgeID_t id)
+{
+    return WireHandle{id, generation(edits.m_wireGeneration, edits.m_baseGeneration, id)};
+}
+
+bool SysEdit::valid(CircuitData& rData, const CircuitEdits& edits, NodeHandle node)
+{
+    return node.m_id != nullNode_t && node.m_id < rData.m_nodes.size() && rData.m_nodes[node.m_id] &&
+        generation(edits.m_nodeGeneration, edits.m_baseGeneration, node.m_id) == node.m_generation;
+}
+
+bool SysEdit::valid(CircuitData& rData, const CircuitEdits& edits, WireHandle wire)
+{
+    return wire.m_id != nullEdge_t && wire.m_id < rData.m_edges.size() && rData.m_edges[wire.m_id] &&
+        generation(edits.m_wireGeneration, edits.m_baseGeneration, wire.m_id) == wire.m_generation;
+}
+
+bool SysEdit::remove_node(CircuitData& rData, CircuitEdits& rEdits, NodeHandle node)
+{
+    if (!SysEdit::valid(rData, rEdits, node))
+    {
+        std::cerr << "SysEdit: stale node handle " << node.m_id << "\n";
+        return false;
+    }
+
+    nodeID_t id = node.m_id;
+    rData.m_nodes[id]->terminals([&rData, id](edgeID_t& rWire, bool)
+    {
+        if (rWire == nullEdge_t || rWire >= rData.m_edges.size() || !rData.m_edges[rWire]) { return; }
+        Connection& rConnection = *rData.m_edges[rWire];
+        if (rConnection.m_in == id) { rConnection.m_in = nullNode_t; }
+        if (rConnection.m_out == id) { rConnection.m_out = nullNode_t; }
+    });
+    rData.m_nodes[id] = nullptr;
+    retire(rEdits.m_nodeGeneration, rEdits, id);
+    rEdits.m_freeNodes.push_back(id);
+    return true;
+}
+
+bool SysEdit::remove_wire(CircuitData& rData, CircuitEdits& rEdits, WireHandle wire, std::vector<nodeID_t>* pDetached)
+{
+    return SysEdit::remove_wires(rData, rEdits, {wire}, pDetached) == 1;
+}
+
+bool SysEdit::remove_wire(CircuitData& rData, CircuitEdits& rEdits, LiveSchedule& rLive, WireHandle wire)
+{
+    if (!SysEdit::valid(rData, rEdits, wire))
+    {
+        std::cerr << "SysEdit: stale wire handle " << wire.m_id << "\n";
+        return false;
+    }
+
+    edgeID_t id = wire.m_id;
+    std::vector<nodeID_t> attached;
+    if (id < rLive.m_readers.size())
+    {
+        attached = rLive.m_readers[id];
+        if (rLive.m_driver[id] != nullNode_t) { attached.push_back(rLive.m_driver[id]); }
+    }
+    std::sort(attached.begin(), attached.end());
+    attached.erase(std::unique(attached.begin(), attached.end()), attached.end());
+    for (nodeID_t node : attached)
+    {
+        if (!rData.m_nodes[node]) { continue; }
+        rData.m_nodes[node]->terminals([id](edgeID_t& rWire, bool)
+        {
+            if (rWire == id) { rWire = nullEdge_t; }
+        });
+    }
+
+    rData.m_edges[id] = nullptr;
+    retire(rEdits.m_wireGeneration, rEdits, id);
+    rEdits.m_freeWires.push_back(id);
+    SysLive::update(rLive, rData, attached);
+    return true;
+}
+
+size_t SysEdit::remove_wires(CircuitData& rData, CircuitEdits& rEdits, const std::vector<WireHandle>& wires,
+                             std::vector<nodeID_t>* pDetached)
+{
+    std::vector<uint8_t> removed(rData.m_edges.size(), 0);
+    size_t count = 0;
+    for (WireHandle wire : wires)
+    {
+        if (!SysEdit::valid(rData, rEdits, wire))
+        {
+            std::cerr << "SysEdit: stale wire handle " << wire.m_id << "\n";
+            continue;
+        }
+        if (removed[wire.m_id]) { continue; }
+        removed[wire.m_id] = 1;
+        count++;
+    }
+    if (count == 0) { return 0; }
+
+    // Wires don't record their fanout, so every node's terminals are checked.
+    for (nodeID_t id = 1; id < rData.m_nodes.size(); id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        bool detached = false;
+        rData.m_nodes[id]->terminals([&removed, &detached](edgeID_t& rWire, bool)
+        {
+            if (rWire < removed.size() && removed[rWire])
+            {
+                rWire = nullEdge_t;
+                detached = true;
+            }
+        });
+        if (detached && pDetached) { pDetached->push_back(id); }
+    }
+
+    for (edgeID_t id = 1; id < removed.size(); id++)
+    {
+        if (!removed[id]) { continue; }
+        rData.m_edges[id] = nullptr;
+        retire(rEdits.m_wireGeneration, rEdits, id);
+        rEdits.m_freeWires.push_back(id);
+    }
+    return count;
+}
+
+Renumbering SysEdit::compact(CircuitData& rData, CircuitEdits& rEdits)
+{
+    size_t numNodes = rData.m_nodes.size();
+    size_t numWires = rData.m_edges.size();
+
+    Renumbering result;
+    result.m_newNode.assign(numNodes, nullNode_t);
+    result.m_newWire.assign(numWires, nullEdge_t);
+    nodeID_t liveNodes = 1;
+    for (nodeID_t id = 1; id < numNodes; id++)
+    {
+        if (rData.m_nodes[id]) { result.m_newNode[id] = liveNodes++; }
+    }
+    edgeID_t liveWires = 1;
+    for (edgeID_t id = 1; id < numWires; id++)
+    {
+        if (rData.m_edges[id]) { result.m_newWire[id] = liveWires++; }
+    }
+
+    // New IDs never exceed old ones, so slots can move down in place.
+    for (nodeID_t id = 1; id < numNodes; id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        rData.m_nodes[id]->terminals([&](edgeID_t& rWire, bool)
+        {
+            if (rWire < numWires) { rWire = result.m_newWire[rWire]; }
+        });
+        if (result.m_newNode[id] != id) { rData.m_nodes[result.m_newNode[id]] = std::move(rData.m_nodes[id]); }
+    }
+    for (edgeID_t id = 1; id < numWires; id++)
+    {
+        if (!rData.m_edges[id]) { continue; }
+        Connection& rConnection = *rData.m_edges[id];
+        if (rConnection.m_in < numNodes) { rConnection.m_in = result.m_newNode[rConnection.m_in]; }
+        if (rConnection.m_out < numNodes) { rConnection.m_out = result.m_newNode[rConnection.m_out]; }
+        if (result.m_newWire[id] != id) { rData.m_edges[result.m_newWire[id]] = std::move(rData.m_edges[id]); }
+    }
+
+    rData.m_nodes.resize(liveNodes);
+    rData.m_nodes.shrink_to_fit();
+    rData.m_edges.resize(liveWires);
+    rData.m_edges.shrink_to_fit();
+
+    rEdits = CircuitEdits{{}, {}, {}, {}, rEdits.m_nextGeneration, rEdits.m_nextGeneration + 1};
+    return result;
+}
+
+bool SysEdit::maybe_compact(CircuitData& rData, CircuitEdits& rEdits, float maxFree, Renumbering* pRenumbering)
+{
+    size_t slots = rData.m_nodes.size() + rData.m_edges.size();
+    size_t free = rEdits.m_freeNodes.size() + rEdits.m_freeWires.size();
+    if (free <= maxFree * slots) { return false; }
+
+    Renumbering renumbering = SysEdit::compact(rData, rEdits);
+    if (pRenumbering) { *pRenumbering = std::move(renumbering); }
+    return true;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "LiveSchedule.h"
+#include "Reorder.h"
+
+// IN-PLACE EDITING
+
+// Node or wire ID plus the generation of the slot when the handle was taken. A handle goes stale when its node or wire
+// is removed, or when SysEdit::compact renumbers the circuit.
+struct NodeHandle
+{
+    nodeID_t m_id{nullNode_t};
+    uint32_t m_generation{0};
+};
+
+struct WireHandle
+{
+    edgeID_t m_id{nullEdge_t};
+    uint32_t m_generation{0};
+};
+
+/**
+ * Generations and free slots for a CircuitData that is edited in place. Removal empties the slot and bumps its
+ * generation, and the slot is reused by the next SysEdit::add or SysEdit::connect. Slots without an entry are at
+ * m_baseGeneration, so circuits built with the plain calls need no setup. While this is in use, only SysEdit::compact
+ * may renumber the circuit.
+ */
+struct CircuitEdits
+{
+    std::vector<uint32_t> m_nodeGeneration;     // per node slot, for slots edited since the last compaction
+    std::vector<uint32_t> m_wireGeneration;     // per wire slot, likewise
+    std::vector<nodeID_t> m_freeNodes;
+    std::vector<edgeID_t> m_freeWires;
+    uint32_t m_baseGeneration{0};
+    uint32_t m_nextGeneration{1};
+};
+
+namespace SysEdit
+{
+NodeHandle node_handle(const CircuitEdits& edits, nodeID_t id);
+WireHandle wire_handle(const CircuitEdits& edits, edgeID_t id);
+
+// True if the handle's node or wire is still there.
+bool valid(CircuitData& rData, const CircuitEdits& edits, NodeHandle node);
+bool valid(CircuitData& rData, const CircuitEdits& edits, WireHandle wire);
+
+template <typename NODE_T>
+std::shared_ptr<NODE_T> get(CircuitData& rData, const CircuitEdits& edits, NodeHandle node)
+{
+    if (!SysEdit::valid(rData, edits, node)) { return nullptr; }
+    return std::static_pointer_cast<NODE_T>(rData.m_nodes[node.m_id]);
+}
+
+// CircuitData::add that fills a free slot first.
+template <typename NODE_T, typename ... ARGS_T>
+NodeHandle add(CircuitData& rData, CircuitEdits& rEdits, ARGS_T&& ...args)
+{
+    if (rEdits.m_freeNodes.empty())
+    {
+        return SysEdit::node_handle(rEdits, rData.add<NODE_T>(std::forward<ARGS_T>(args)...));
+    }
+    nodeID_t id = rEdits.m_freeNodes.back();
+    rEdits.m_freeNodes.pop_back();
+    rData.m_nodes[id] = std::make_shared<NODE_T>(std::forward<ARGS_T>(args)...);
+    return SysEdit::node_handle(rEdits, id);
+}
+
+// SysCircuit::connect that fills a free wire slot first.
+template <typename TYPE_T>
+WireHandle connect(CircuitData& rData, CircuitEdits& rEdits, NodeTerminal<TYPE_T>& a, NodeTerminal<TYPE_T>& b)
+{
+    if (rEdits.m_freeWires.empty())
+    {
+        SysCircuit::connect(rData, a, b);
+        return SysEdit::wire_handle(rEdits, a.m_id);
+    }
+    edgeID_t id = rEdits.m_freeWires.back();
+    rEdits.m_freeWires.pop_back();
+    std::shared_ptr<TYPE_T> connection = std::make_shared<TYPE_T>();
+    connection->m_in = a.m_parentID;
+    connection->m_out = b.m_parentID;
+    rData.m_edges[id] = connection;
+
+    a.m_id = id;
+    b.m_id = id;
+    return SysEdit::wire_handle(rEdits, id);
+}
+
+/**
+ * Empties the node's slot. Wires it was attached to stay, so its outputs keep their last value until something else
+ * drives them, and readers of those wires are unaffected. Any m_in/m_out naming the node is cleared. Returns false for
+ * a stale handle.
+ */
+bool remove_node(CircuitData& rData, CircuitEdits& rEdits, NodeHandle node);
+
+/**
+ * Empties the wire's slot and detaches every terminal attached to it, driver and all readers, so the slot can be reused
+ * safely. Wires don't record their readers, so this walks the terminals of every live node: O(nodes) per call. Use
+ * remove_wires to take out several in one walk, or the LiveSchedule overload, which finds them through its reader
+ * index. The nodes whose terminals were detached are appended to pDetached (for SysLive::update). Returns false for a
+ * stale handle.
+ */
+bool remove_wire(CircuitData& rData, CircuitEdits& rEdits, WireHandle wire, std::vector<nodeID_t>* pDetached = nullptr);
+
+// remove_wire in O(fanout), for circuits kept in a LiveSchedule. rLive must be up to date; it is updated for the
+// detached nodes before returning.
+bool remove_wire(CircuitData& rData, CircuitEdits& rEdits, LiveSchedule& rLive, WireHandle wire);
+
+// remove_wire for a list of wires, with one walk over the nodes. Stale handles are skipped; returns how many were removed.
+size_t remove_wires(CircuitData& rData, CircuitEdits& rEdits, const std::vector<WireHandle>& wires,
+                    std::vector<nodeID_t>* pDetached = nullptr);
+
+/**
+ * Packs the live nodes and wires down to the front of storage, keeping their order, frees the chunks no longer used and
+ * clears the free lists. Terminals still naming a removed wire are detached. Every handle goes stale; the returned
+ * Renumbering maps old IDs to new ones, with removed ones mapped to null.
+ */
+Renumbering compact(CircuitData& rData, CircuitEdits& rEdits);
+
+// Compacts if more than maxFree of the slots are free. Returns whether it did.
+bool maybe_compact(CircuitData& rData, CircuitEdits& rEdits, float maxFree = 0.25f, Renumbering* pRenumbering = nullptr);
+}
@@ -6,7 +6,6 @@
 int main()
 {
     CircuitData data;
-    data.m_nodes.reserve(5);
 
     auto printer = data.get<Printer<uint32_t>>(data.add<Printer<uint32_t>>());
 
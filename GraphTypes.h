@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cassert>
+#include <type_traits>
 #include <vector>
 #include <queue>
 #include <tuple>
@@ -19,13 +21,35 @@ struct IInput { virtual void accept_input(T) = 0; };
 template<typename T>
 struct IOutput { virtual T return_output(void) = 0; };
 
+/**
+ * Statically dispatched counterparts of IInput/IOutput, for the adapters below. The derived class implements
+ * on_input()/on_output() and the connection templates, which already know the concrete type, call straight through
+ * with no virtual call and no vtable pointer in the adapter.
+ * Wrap an adapter in VirtualInput/VirtualOutput when it has to live in a heterogeneous container behind IInput/IOutput.
+ */
+template<typename DERIVED_T, typename T>
+struct StaticInput
+{
+    typedef T input_type;
+
+    void accept_input(T t) { static_cast<DERIVED_T*>(this)->on_input(std::move(t)); }
+};
+
+template<typename DERIVED_T, typename T>
+struct StaticOutput
+{
+    typedef T output_type;
+
+    T return_output() { return static_cast<DERIVED_T*>(this)->on_output(); }
+};
+
 /**
  * Constructed with only pointer to parent object. Member function to call is compile-time template parameter.
  * Very useful when you want multiple different inputs of the same type to get pre-processed during the "distribute" step.
  * Calls a function in the parent class, which can do whatever.
  */
 template<typename DATA_T, typename PARENT_T, void (PARENT_T::*POINTER_TO_MEMBER)(DATA_T)>
-struct MemberInput : IInput<DATA_T>
+struct MemberInput : StaticInput<MemberInput<DATA_T, PARENT_T, POINTER_TO_MEMBER>, DATA_T>
 {
     MemberInput(PARENT_T* pParent)
         : m_pParent(pParent)
@@ -33,7 +57,7 @@ struct MemberInput : IInput<DATA_T>
         assert(m_pParent != nullptr);
     }
 
-    void accept_input(DATA_T t) override final
+    void on_input(DATA_T t)
     {
         (m_pParent->*POINTER_TO_MEMBER)(std::move(t));
     }
@@ -45,9 +69,9 @@ struct MemberInput : IInput<DATA_T>
  * Useful for elements that don't need any kind of pre-processing during the distribute step.
  */
 template<typename DATA_T, typename PARENT_T, void (PARENT_T::*POINTER_TO_MEMBER)(DATA_T)>
-struct BufferedMemberInput : IInput<DATA_T>
+struct BufferedMemberInput : StaticInput<BufferedMemberInput<DATA_T, PARENT_T, POINTER_TO_MEMBER>, DATA_T>
 {
-    void accept_input(DATA_T t) override final
+    void on_input(DATA_T t)
     {
         m_buffer = std::move(t);
     }
@@ -58,9 +82,9 @@ struct BufferedMemberInput : IInput<DATA_T>
  * Note, totally ignorant of it's parent object. Exists only to have the return_output() function, and storage for one buffer of type DATA_T.
  */
 template<typename DATA_T>
-struct MemberOutput : IOutput<DATA_T>
+struct MemberOutput : StaticOutput<MemberOutput<DATA_T>, DATA_T>
 {
-    DATA_T return_output() override final
+    DATA_T on_output()
     {
         // Use std::move because the buffer is consumed upon this function call.
         // If it's not a movable type, the value remains the same.
@@ -72,6 +96,26 @@ struct MemberOutput : IOutput<DATA_T>
     DATA_T m_buffer;
 };
 
+/**
+ * Opt-in virtual interface for a statically dispatched adapter, e.g. VirtualInput<MemberInput<...>> can be stored as an IInput<DATA_T>*.
+ * Constructors are forwarded to the adapter.
+ */
+template<typename ADAPTER_T>
+struct VirtualInput : ADAPTER_T, IInput<typename ADAPTER_T::input_type>
+{
+    using ADAPTER_T::ADAPTER_T;
+
+    void accept_input(typename ADAPTER_T::input_type t) override final { ADAPTER_T::accept_input(std::move(t)); }
+};
+
+template<typename ADAPTER_T>
+struct VirtualOutput : ADAPTER_T, IOutput<typename ADAPTER_T::output_type>
+{
+    using ADAPTER_T::ADAPTER_T;
+
+    typename ADAPTER_T::output_type return_output() override final { return ADAPTER_T::return_output(); }
+};
+
 /**
  * Base class of connection objects. The distribute function accepts no arguments. Connections need to know what they are connecting.
  */
@@ -96,7 +140,7 @@ struct MainComputer : IInput<EjectButton> // you could totally inherit from IInp
 };
 #endif
 
-struct ORGate : IOutput<bool>
+struct ORGate : StaticOutput<ORGate, bool>
 {
     void accept_pin1_input(bool pin) { m_pinOne.accept_input(pin); }
     void accept_pin2_input(bool pin) { m_pinTwo.accept_input(pin); }
@@ -106,10 +150,10 @@ struct ORGate : IOutput<bool>
     bool m_output;
 
     void process() { m_output = (m_pinOne.m_buffer || m_pinTwo.m_buffer); }
-    bool return_output() override final { return m_output; }
+    bool on_output() { return m_output; }
 };
 
-struct ANDGate : IOutput<bool>
+struct ANDGate : StaticOutput<ANDGate, bool>
 {
     void accept_pin1_input(bool pin) { m_pinOne.accept_input(pin); }
     void accept_pin2_input(bool pin) { m_pinTwo.accept_input(pin); }
@@ -119,7 +163,7 @@ struct ANDGate : IOutput<bool>
     bool m_output;
 
     void process() { m_output = (m_pinOne.m_buffer && m_pinTwo.m_buffer); }
-    bool return_output() override final { return m_output; }
+    bool on_output() { return m_output; }
 };
 
 template<typename SOURCE_ONE_T, typename SOURCE_TWO_T, typename SINK_T>
@@ -132,7 +176,7 @@ struct ORGateImm : IConnection
 
     void distribute() override final
     {
-        sink.accept_input(sourceOne.return_output() || sourceTwo.return_output());
+        sink->accept_input(sourceOne->return_output() || sourceTwo->return_output());
     }
 
     std::shared_ptr<SOURCE_ONE_T> sourceOne;
@@ -150,7 +194,7 @@ struct ANDGateImm : IConnection
 
     void distribute() override final
     {
-        sink.accept_input(sourceOne.return_output() && sourceTwo.return_output());
+        sink->accept_input(sourceOne->return_output() && sourceTwo->return_output());
     }
 
     std::shared_ptr<SOURCE_ONE_T> sourceOne;
@@ -158,6 +202,112 @@ struct ANDGateImm : IConnection
     std::shared_ptr<SINK_T> sink;
 };
 
+/**
+ * Expression templates for immediate gates. imm() wraps a source, and combining wrapped sources with |, &, ^ and !
+ * builds up a single expression type instead of a chain of connections. Hand the finished expression to
+ * make_fused() to get one connection whose distribute() evaluates the whole thing inline:
+ *
+ *     auto conn = make_fused((imm(a) | imm(b)) & !imm(c), sink);
+ *
+ * Unlike ORGateImm/ANDGateImm there's no short-circuiting: every source's return_output() is called on every
+ * distribute(), which keeps the evaluation branch-free and consumes each source exactly once per cycle.
+ */
+struct ImmExpr {};
+
+template<typename T>
+constexpr bool is_imm_expr_v = std::is_base_of_v<ImmExpr, T>;
+
+template<typename SOURCE_T>
+struct ImmSource : ImmExpr
+{
+    ImmSource(std::shared_ptr<SOURCE_T> src) : source(std::move(src)) {}
+
+    bool evaluate() { return bool(source->return_output()); }
+
+    std::shared_ptr<SOURCE_T> source;
+};
+
+template<typename A, typename B>
+struct ImmOr : ImmExpr
+{
+    ImmOr(A a, B b) : a(std::move(a)), b(std::move(b)) {}
+
+    bool evaluate() { return a.evaluate() | b.evaluate(); }
+
+    A a;
+    B b;
+};
+
+template<typename A, typename B>
+struct ImmAnd : ImmExpr
+{
+    ImmAnd(A a, B b) : a(std::move(a)), b(std::move(b)) {}
+
+    bool evaluate() { return a.evaluate() & b.evaluate(); }
+
+    A a;
+    B b;
+};
+
+template<typename A, typename B>
+struct ImmXor : ImmExpr
+{
+    ImmXor(A a, B b) : a(std::move(a)), b(std::move(b)) {}
+
+    bool evaluate() { return a.evaluate() ^ b.evaluate(); }
+
+    A a;
+    B b;
+};
+
+template<typename A>
+struct ImmNot : ImmExpr
+{
+    ImmNot(A a) : a(std::move(a)) {}
+
+    bool evaluate() { return !a.evaluate(); }
+
+    A a;
+};
+
+template<typename SOURCE_T>
+ImmSource<SOURCE_T> imm(std::shared_ptr<SOURCE_T> src) { return ImmSource<SOURCE_T>(std::move(src)); }
+
+template<typename A, typename B, typename = std::enable_if_t<is_imm_expr_v<A> && is_imm_expr_v<B>>>
+ImmOr<A, B> operator|(A a, B b) { return ImmOr<A, B>(std::move(a), std::move(b)); }
+
+template<typename A, typename B, typename = std::enable_if_t<is_imm_expr_v<A> && is_imm_expr_v<B>>>
+ImmAnd<A, B> operator&(A a, B b) { return ImmAnd<A, B>(std::move(a), std::move(b)); }
+
+template<typename A, typename B, typename = std::enable_if_t<is_imm_expr_v<A> && is_imm_expr_v<B>>>
+ImmXor<A, B> operator^(A a, B b) { return ImmXor<A, B>(std::move(a), std::move(b)); }
+
+template<typename A, typename = std::enable_if_t<is_imm_expr_v<A>>>
+ImmNot<A> operator!(A a) { return ImmNot<A>(std::move(a)); }
+
+template<typename EXPR_T, typename SINK_T>
+struct FusedConnection : IConnection
+{
+    FusedConnection(EXPR_T expr, std::shared_ptr<SINK_T> sink)
+        : expr(std::move(expr)), sink(sink)
+    {}
+
+    void distribute() override final
+    {
+        sink->accept_input(expr.evaluate());
+    }
+
+    EXPR_T expr;
+    std::shared_ptr<SINK_T> sink;
+};
+
+template<typename EXPR_T, typename SINK_T>
+FusedConnection<EXPR_T, SINK_T> make_fused(EXPR_T expr, std::shared_ptr<SINK_T> sink)
+{
+    static_assert(is_imm_expr_v<EXPR_T>, "make_fused() takes an expression built from imm()");
+    return FusedConnection<EXPR_T, SINK_T>(std::move(expr), std::move(sink));
+}
+
 template<typename SOURCE, typename SINK>
 struct UniDirectionalConnection : IConnection
 {
@@ -167,7 +317,7 @@ struct UniDirectionalConnection : IConnection
 
     void distribute() override final
     {
-        sink.accept_input(source.return_output());
+        sink->accept_input(source->return_output());
     }
 
     std::shared_ptr<SOURCE> source;
@@ -183,8 +333,8 @@ struct BiDirectionalConnection : IConnection
 
     void distribute() override final
     {
-        a.accept_input(b.return_output());
-        b.accept_input(a.return_output());
+        a->accept_input(b->return_output());
+        b->accept_input(a->return_output());
     }
 
     std::shared_ptr<A> a;
@@ -198,7 +348,7 @@ struct ReflectionConnection : IConnection
 
     void distribute() override final
     {
-        a.accept_input(a.return_output());
+        a->accept_input(a->return_output());
     }
 
     std::shared_ptr<A> a;
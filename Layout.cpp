@@ -0,0 +1,184 @@
+#include "Layout.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+
+constexpr uint32_t c_many = noneID_t - 1;
+
+// Writer and reader parts of one cache line. noneID_t is nobody yet, c_many is more than one part.
+struct LineUse
+{
+    uint32_t m_writer{noneID_t};
+    bool m_crossRead{false};
+    std::vector<edgeID_t> m_wires;
+};
+
+uint32_t merge(uint32_t current, uint32_t part)
+{
+    if (current == noneID_t || current == part) { return part; }
+    return c_many;
+}
+
+// Places the wires driven by one part into rArena; the slots in rData alias pOwner, which keeps them alive.
+void pack_part(CircuitData& rData, const NetlistGraph& graph, const Partitioning& partitioning, uint32_t part,
+               WireArena& rArena, const std::shared_ptr<WireArena>& pOwner)
+{
+    rArena.next_line();
+    for (edgeID_t wire = 0; wire < graph.num_wires(); wire++)
+    {
+        nodeID_t driver = graph.m_driver[wire];
+        if (driver == nullNode_t || partitioning.m_part[driver] != part) { continue; }
+        if (Connection* pWire = rArena.place(*rData.m_edges[wire]))
+        {
+            rData.m_edges[wire] = std::shared_ptr<Connection>(pOwner, pWire);
+        }
+    }
+}
+
+} // namespace
+
+WireArena::~WireArena()
+{
+    for (Connection* pWire : m_placed) { pWire->~Connection(); }
+    for (uint8_t* pChunk : m_chunks) { std::free(pChunk); }
+}
+
+Connection* WireArena::place(const Connection& wire)
+{
+    size_t size = wire.storage_size();
+    size_t align = std::max<size_t>(wire.storage_align(), 1);
+    if (size == 0 || size > m_chunkSize || align > lineSize_t) { return nullptr; }
+
+    size_t offset = (m_used + align - 1) / align * align;
+    if (m_chunks.empty() || offset + size > m_chunkSize)
+    {
+        void* pChunk = std::aligned_alloc(lineSize_t, m_chunkSize);
+        if (pChunk == nullptr) { return nullptr; }
+        m_chunks.push_back(static_cast<uint8_t*>(pChunk));
+        offset = 0;
+    }
+
+    Connection* pWire = wire.copy_to(m_chunks.back() + offset);
+    m_placed.push_back(pWire);
+    m_used = offset + size;
+    return pWire;
+}
+
+void WireArena::next_line()
+{
+    m_used = (m_used + lineSize_t - 1) / lineSize_t * lineSize_t;
+}
+
+std::shared_ptr<Connection> SysLayout::place(const std::shared_ptr<WireArena>& pArena, const Connection& wire)
+{
+    if (Connection* pWire = pArena->place(wire)) { return std::shared_ptr<Connection>(pArena, pWire); }
+    return wire.clone();
+}
+
+std::shared_ptr<WireArena> SysLayout::pack_wires(CircuitData& rData, const Partitioning& partitioning)
+{
+    NetlistGraph graph = SysNetlist::build(rData);
+    auto pArena = std::make_shared<WireArena>();
+    for (uint32_t part = 0; part < partitioning.m_numParts; part++)
+    {
+        pack_part(rData, graph, partitioning, part, *pArena, pArena);
+    }
+    return pArena;
+}
+
+std::shared_ptr<WireArena> SysLayout::pack_wires(CircuitData& rData, const Partitioning& partitioning,
+                                                 const NumaPlacement& placement)
+{
+    NetlistGraph graph = SysNetlist::build(rData);
+    auto pArena = std::make_shared<WireArena>();
+
+    // Each thread fills an arena of its own and only replaces the m_edges entries its part drives, so they can run
+    // side by side. The chunks are handed over to pArena afterwards.
+    std::vector<WireArena> partArenas(partitioning.m_numParts);
+    auto fill = [&](uint32_t part)
+    {
+        if (part < placement.m_workerCpus.size()) { SysNuma::pin_current_thread(placement.m_workerCpus[part]); }
+        pack_part(rData, graph, partitioning, part, partArenas[part], pArena);
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t part = 0; part < partitioning.m_numParts; part++) { threads.emplace_back(fill, part); }
+    for (std::thread& thread : threads) { thread.join(); }
+
+    for (WireArena& rPart : partArenas)
+    {
+        pArena->m_chunks.insert(pArena->m_chunks.end(), rPart.m_chunks.begin(), rPart.m_chunks.end());
+        pArena->m_placed.insert(pArena->m_placed.end(), rPart.m_placed.begin(), rPart.m_placed.end());
+        rPart.m_chunks.clear();
+        rPart.m_placed.clear();
+    }
+    // Any further place() calls start a fresh chunk rather than sharing the last part's.
+    pArena->m_used = pArena->m_chunkSize;
+    return pArena;
+}
+
+SharingReport SysLayout::check_sharing(CircuitData& rData, const Partitioning& partitioning)
+{
+    NetlistGraph graph = SysNetlist::build(rData);
+    std::unordered_map<uintptr_t, LineUse> lines;
+    for (edgeID_t wire = 0; wire < graph.num_wires(); wire++)
+    {
+        nodeID_t driver = graph.m_driver[wire];
+        if (driver == nullNode_t || partitioning.m_part[driver] == noneID_t) { continue; }
+        uint32_t writer = partitioning.m_part[driver];
+
+        bool crossRead = false;
+        for (uint32_t r = graph.m_readerStart[wire]; r < graph.m_readerStart[wire + 1]; r++)
+        {
+            crossRead |= partitioning.m_part[graph.m_readers[r]] != writer;
+        }
+
+        uintptr_t first = reinterpret_cast<uintptr_t>(rData.m_edges[wire].get());
+        uintptr_t last = first + std::max<size_t>(rData.m_edges[wire]->storage_size(), 1) - 1;
+        for (uintptr_t line = first / lineSize_t; line <= last / lineSize_t; line++)
+        {
+            LineUse& rUse = lines[line];
+            rUse.m_writer = merge(rUse.m_writer, writer);
+            rUse.m_crossRead |= crossRead;
+            rUse.m_wires.push_back(wire);
+        }
+    }
+
+    SharingReport report;
+    report.m_lines = lines.size();
+    for (auto& [line, use] : lines)
+    {
+        if (use.m_writer == c_many)
+        {
+            report.m_multiWriterLines++;
+            report.m_contended.insert(report.m_contended.end(), use.m_wires.begin(), use.m_wires.end());
+        }
+        else if (use.m_crossRead)
+        {
+            report.m_crossReadLines++;
+        }
+    }
+    std::sort(report.m_contended.begin(), report.m_contended.end());
+    report.m_contended.erase(std::unique(report.m_contended.begin(), report.m_contended.end()), report.m_contended.end());
+    return report;
+}
+
+void SysLayout::print(const SharingReport& report, std::ostream& rOut)
+{
+    rOut << "wire cache lines: " << report.m_lines << "\n";
+    rOut << "  written by more than one part: " << report.m_multiWriterLines << " ("
+         << report.m_contended.size() << " wires)\n";
+    rOut << "  written by one part, read by another: " << report.m_crossReadLines << "\n";
+
+    constexpr size_t c_maxListed = 16;
+    if (report.m_contended.empty()) { return; }
+    rOut << "  contended wires:";
+    for (size_t i = 0; i < std::min(report.m_contended.size(), c_maxListed); i++) { rOut << " " << report.m_contended[i]; }
+    if (report.m_contended.size() > c_maxListed) { rOut << " ..."; }
+    rOut << "\n";
+}
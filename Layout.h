@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "CacheLine.h"
+#include "Numa.h"
+#include "Partition.h"
+
+// WIRE LAYOUT
+
+/**
+ * Bump allocator for wires. Wires are copied in back to back with Connection::copy_to, and next_line() starts a fresh
+ * cache line, so groups of wires written by different threads never share one. Wires live until the arena is
+ * destroyed; hand them out through SysLayout::place so every user keeps the arena alive.
+ */
+struct WireArena
+{
+    WireArena(size_t chunkSize = 64 * 1024) : m_chunkSize(chunkSize) {}
+    WireArena(const WireArena&) = delete;
+    WireArena& operator=(const WireArena&) = delete;
+    ~WireArena();
+
+    // Copies the wire in, or returns nullptr if it doesn't support placement.
+    Connection* place(const Connection& wire);
+
+    void next_line();
+
+    std::vector<uint8_t*> m_chunks;
+    std::vector<Connection*> m_placed;
+    size_t m_chunkSize;
+    size_t m_used{0};       // bytes of the last chunk
+};
+
+/**
+ * Cache lines holding driven wires, with each part's nodes running on its own thread straight off rData. A line
+ * written by more than one part is false sharing; a line written by one part and read by another carries a real
+ * dependency, but still moves between cores every cycle, along with anything else on it. (run_partitioned reads cut
+ * wires through per-part shadows, so there only the first kind costs anything.)
+ */
+struct SharingReport
+{
+    size_t m_lines{0};
+    size_t m_multiWriterLines{0};
+    size_t m_crossReadLines{0};
+    std::vector<edgeID_t> m_contended;      // wires on multi-writer lines
+};
+
+namespace SysLayout
+{
+// WireArena::place wrapped in a shared_ptr that keeps the arena alive. Falls back to Connection::clone().
+std::shared_ptr<Connection> place(const std::shared_ptr<WireArena>& pArena, const Connection& wire);
+
+/**
+ * Moves every driven wire into one arena, grouped by the part that drives it and in ID order within a part, with each
+ * part's group starting on its own cache line. Wires that can't be placed stay where they are. References to the old
+ * wire objects go stale; wire IDs don't change.
+ * The arena is first touched by the calling thread, so after SysNuma::relocate use the overload taking the placement,
+ * or every wire ends up on the caller's NUMA node.
+ */
+std::shared_ptr<WireArena> pack_wires(CircuitData& rData, const Partitioning& partitioning);
+
+// pack_wires with each part's wires in chunks of their own, filled by a thread pinned like the part's worker, so they
+// are first touched on its NUMA node (as SysNuma::relocate does).
+std::shared_ptr<WireArena> pack_wires(CircuitData& rData, const Partitioning& partitioning,
+                                      const NumaPlacement& placement);
+
+// Looks at where the wires actually are in memory and which parts write and read them.
+SharingReport check_sharing(CircuitData& rData, const Partitioning& partitioning);
+
+void print(const SharingReport& report, std::ostream& rOut);
+}
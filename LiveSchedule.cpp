@@ -0,0 +1,360 @@
+#include "LiveSchedule.h"
+
+#include <algorithm>
+
+namespace
+{
+
+template <typename T>
+void grow(std::vector<T>& rVector, size_t size, const T& fill)
+{
+    if (rVector.size() < size) { rVector.resize(size, fill); }
+}
+
+void fit(LiveSchedule& rLive, CircuitData& rData)
+{
+    size_t numNodes = rData.m_nodes.size();
+    size_t numWires = rData.m_edges.size();
+    grow(rLive.m_inputs, numNodes, {});
+    grow(rLive.m_outputs, numNodes, {});
+    grow(rLive.m_readerSlot, numNodes, {});
+    grow(rLive.m_attached, numNodes, {});
+    grow(rLive.m_combinational, numNodes, uint8_t(0));
+    grow(rLive.m_level, numNodes, noneID_t);
+    grow(rLive.m_position, numNodes, noneID_t);
+    grow(rLive.m_partitioning.m_part, numNodes, noneID_t);
+    grow(rLive.m_driver, numWires, nullNode_t);
+    grow(rLive.m_readers, numWires, {});
+    grow(rLive.m_readerInput, numWires, {});
+    grow(rLive.m_cut, numWires, uint8_t(0));
+}
+
+// Swap-removes id from rList, where rPosition says it is.
+void unlink(std::vector<nodeID_t>& rList, std::vector<uint32_t>& rPosition, nodeID_t id)
+{
+    uint32_t position = rPosition[id];
+    nodeID_t last = rList.back();
+    rList[position] = last;
+    rPosition[last] = position;
+    rList.pop_back();
+    rPosition[id] = noneID_t;
+}
+
+void unplace(LiveSchedule& rLive, nodeID_t id)
+{
+    if (rLive.m_position[id] == noneID_t) { return; }
+    uint32_t level = rLive.m_level[id];
+    unlink(level == noneID_t ? rLive.m_clocked : rLive.m_levels[level], rLive.m_position, id);
+    rLive.m_level[id] = noneID_t;
+}
+
+// Into m_clocked for level == noneID_t, otherwise into that level's bucket.
+void place(LiveSchedule& rLive, nodeID_t id, uint32_t level)
+{
+    rLive.m_level[id] = level;
+    std::vector<nodeID_t>* pList = &rLive.m_clocked;
+    if (level != noneID_t)
+    {
+        grow(rLive.m_levels, size_t(level) + 1, {});
+        pList = &rLive.m_levels[level];
+    }
+    rLive.m_position[id] = uint32_t(pList->size());
+    pList->push_back(id);
+}
+
+uint32_t level_from_inputs(const LiveSchedule& live, nodeID_t id)
+{
+    uint32_t level = 0;
+    for (edgeID_t wire : live.m_inputs[id])
+    {
+        nodeID_t driver = live.m_driver[wire];
+        if (driver == nullNode_t || live.m_level[driver] == noneID_t) { continue; }
+        level = std::max(level, live.m_level[driver] + 1);
+    }
+    return level;
+}
+
+// Every node in the circuit has a part, so that doubles as the record of which slots are occupied.
+bool occupied(const LiveSchedule& live, nodeID_t id)
+{
+    return live.m_partitioning.m_part[id] != noneID_t;
+}
+
+// Records the node's current terminals and combinational flag.
+void attach(LiveSchedule& rLive, CircuitData& rData, nodeID_t id)
+{
+    std::shared_ptr<Node>& rNode = rData.m_nodes[id];
+    rLive.m_combinational[id] = rNode && rNode->combinational();
+    rLive.m_attached[id] = rNode;
+    if (!rNode) { return; }
+    rNode->terminals([&rLive, &rData, id](edgeID_t& rWire, bool isOutput)
+    {
+        if (rWire == nullEdge_t || rWire >= rData.m_edges.size()) { return; }
+        if (isOutput)
+        {
+            rLive.m_outputs[id].push_back(rWire);
+            rLive.m_driver[rWire] = id;
+        }
+        else
+        {
+            rLive.m_readerSlot[id].push_back(uint32_t(rLive.m_readers[rWire].size()));
+            rLive.m_readerInput[rWire].push_back(uint32_t(rLive.m_inputs[id].size()));
+            rLive.m_inputs[id].push_back(rWire);
+            rLive.m_readers[rWire].push_back(id);
+        }
+    });
+}
+
+void detach(LiveSchedule& rLive, nodeID_t id)
+{
+    // Swap-removes each input's entry from its wire's reader list, like unlink() but with a (node, input) back-reference.
+    for (uint32_t input = 0; input < rLive.m_inputs[id].size(); input++)
+    {
+        edgeID_t wire = rLive.m_inputs[id][input];
+        std::vector<nodeID_t>& rReaders = rLive.m_readers[wire];
+        std::vector<uint32_t>& rReaderInput = rLive.m_readerInput[wire];
+        uint32_t slot = rLive.m_readerSlot[id][input];
+        nodeID_t lastReader = rReaders.back();
+        uint32_t lastInput = rReaderInput.back();
+        rReaders[slot] = lastReader;
+        rReaderInput[slot] = lastInput;
+        rLive.m_readerSlot[lastReader][lastInput] = slot;
+        rReaders.pop_back();
+        rReaderInput.pop_back();
+    }
+    for (edgeID_t wire : rLive.m_outputs[id])
+    {
+        if (rLive.m_driver[wire] == id) { rLive.m_driver[wire] = nullNode_t; }
+    }
+    rLive.m_inputs[id].clear();
+    rLive.m_readerSlot[id].clear();
+    rLive.m_outputs[id].clear();
+}
+
+void update_cut(LiveSchedule& rLive, edgeID_t wire)
+{
+    const std::vector<uint32_t>& part = rLive.m_partitioning.m_part;
+    nodeID_t driver = rLive.m_driver[wire];
+    bool cut = false;
+    if (driver != nullNode_t)
+    {
+        for (nodeID_t reader : rLive.m_readers[wire]) { cut |= part[reader] != part[driver]; }
+    }
+    rLive.m_cut[wire] = cut;
+}
+
+// Part holding most of the node's neighbours, the smallest part on a tie.
+uint32_t pick_part(const LiveSchedule& live, nodeID_t id)
+{
+    const Partitioning& partitioning = live.m_partitioning;
+    std::vector<uint32_t> votes(partitioning.m_numParts, 0);
+    auto vote = [&](nodeID_t other)
+    {
+        if (other == nullNode_t || other == id || partitioning.m_part[other] == noneID_t) { return; }
+        votes[partitioning.m_part[other]]++;
+    };
+    for (edgeID_t wire : live.m_inputs[id]) { vote(live.m_driver[wire]); }
+    for (edgeID_t wire : live.m_outputs[id])
+    {
+        for (nodeID_t reader : live.m_readers[wire]) { vote(reader); }
+    }
+
+    uint32_t best = 0;
+    for (uint32_t part = 1; part < partitioning.m_numParts; part++)
+    {
+        bool more = votes[part] > votes[best];
+        bool tie = votes[part] == votes[best] && partitioning.m_partSize[part] < partitioning.m_partSize[best];
+        if (more || tie) { best = part; }
+    }
+    return best;
+}
+
+// Label-correcting pass: moves each queued node to the level its inputs now give it and queues its readers if it moved.
+// On a loop this would go on forever, so it gives up (returning false) once it has moved as many nodes as there are;
+// the caller then levels from scratch, which settles whether there is a loop in linear time.
+bool relevel(LiveSchedule& rLive, std::vector<nodeID_t>& rQueue)
+{
+    size_t budget = rLive.m_level.size();
+    for (size_t head = 0; head < rQueue.size(); head++)
+    {
+        nodeID_t id = rQueue[head];
+        if (!rLive.m_combinational[id]) { continue; }
+        uint32_t level = level_from_inputs(rLive, id);
+        if (level == rLive.m_level[id]) { continue; }
+        if (rLive.m_relevelled == budget) { return false; }
+
+        unplace(rLive, id);
+        place(rLive, id, level);
+        rLive.m_relevelled++;
+        for (edgeID_t wire : rLive.m_outputs[id])
+        {
+            rQueue.insert(rQueue.end(), rLive.m_readers[wire].begin(), rLive.m_readers[wire].end());
+        }
+    }
+    return true;
+}
+
+// Levels from scratch (Kahn's algorithm over the combinational nodes). Returns false if some are on a loop.
+bool relevel_all(LiveSchedule& rLive)
+{
+    size_t numNodes = rLive.m_level.size();
+    rLive.m_clocked.clear();
+    rLive.m_levels.clear();
+    std::fill(rLive.m_level.begin(), rLive.m_level.end(), noneID_t);
+    std::fill(rLive.m_position.begin(), rLive.m_position.end(), noneID_t);
+
+    std::vector<uint32_t> pending(numNodes, 0);
+    std::vector<nodeID_t> ready;
+    size_t numCombinational = 0;
+    for (nodeID_t id = 1; id < numNodes; id++)
+    {
+        if (!rLive.m_combinational[id])
+        {
+            if (occupied(rLive, id)) { place(rLive, id, noneID_t); }
+            continue;
+        }
+        numCombinational++;
+        for (edgeID_t wire : rLive.m_inputs[id])
+        {
+            if (rLive.m_combinational[rLive.m_driver[wire]]) { pending[id]++; }
+        }
+        if (pending[id] == 0) { ready.push_back(id); }
+    }
+
+    for (size_t head = 0; head < ready.size(); head++)
+    {
+        nodeID_t id = ready[head];
+        place(rLive, id, level_from_inputs(rLive, id));
+        for (edgeID_t wire : rLive.m_outputs[id])
+        {
+            if (rLive.m_driver[wire] != id) { continue; }
+            for (nodeID_t reader : rLive.m_readers[wire])
+            {
+                if (rLive.m_combinational[reader] && --pending[reader] == 0) { ready.push_back(reader); }
+            }
+        }
+    }
+    return ready.size() == numCombinational;
+}
+
+} // namespace
+
+LiveSchedule SysLive::build(CircuitData& rData, uint32_t numParts, uint32_t maxIterations)
+{
+    LiveSchedule live;
+    live.m_maxIterations = maxIterations;
+    fit(live, rData);
+    for (nodeID_t id = 1; id < rData.m_nodes.size(); id++) { attach(live, rData, id); }
+
+    Partitioning& rPartitioning = live.m_partitioning;
+    if (numParts > 1)
+    {
+        rPartitioning = SysPartition::partition(rData, SysNetlist::build(rData), numParts);
+        rPartitioning.m_cutWires.clear();
+    }
+    else
+    {
+        rPartitioning.m_numParts = 1;
+        rPartitioning.m_partSize.assign(1, 0);
+        for (nodeID_t id = 1; id < rData.m_nodes.size(); id++)
+        {
+            if (!rData.m_nodes[id]) { continue; }
+            rPartitioning.m_part[id] = 0;
+            rPartitioning.m_partSize[0]++;
+        }
+    }
+    for (edgeID_t wire = 1; wire < rData.m_edges.size(); wire++) { update_cut(live, wire); }
+
+    live.m_hasLoops = !relevel_all(live);
+    live.m_dirty = live.m_hasLoops;
+    return live;
+}
+
+void SysLive::update(LiveSchedule& rLive, CircuitData& rData, const std::vector<nodeID_t>& changed)
+{
+    fit(rLive, rData);
+    rLive.m_relevelled = 0;
+    Partitioning& rPartitioning = rLive.m_partitioning;
+
+    std::vector<edgeID_t> touched;
+    std::vector<nodeID_t> queue;
+    for (nodeID_t id : changed)
+    {
+        if (id == nullNode_t || id >= rData.m_nodes.size()) { continue; }
+
+        // Readers of what the node drove before and drives now have to be levelled again.
+        auto note = [&]()
+        {
+            touched.insert(touched.end(), rLive.m_inputs[id].begin(), rLive.m_inputs[id].end());
+            for (edgeID_t wire : rLive.m_outputs[id])
+            {
+                touched.push_back(wire);
+                queue.insert(queue.end(), rLive.m_readers[wire].begin(), rLive.m_readers[wire].end());
+            }
+        };
+        // A slot emptied and refilled since the last update holds a different node, which picks its part afresh.
+        bool replaced = rLive.m_attached[id].lock() != rData.m_nodes[id];
+
+        note();
+        unplace(rLive, id);
+        detach(rLive, id);
+        attach(rLive, rData, id);
+        note();
+
+        bool present = rData.m_nodes[id] != nullptr;
+        if (replaced && occupied(rLive, id))
+        {
+            rPartitioning.m_partSize[rPartitioning.m_part[id]]--;
+            rPartitioning.m_part[id] = noneID_t;
+        }
+        if (present && !occupied(rLive, id))
+        {
+            rPartitioning.m_part[id] = pick_part(rLive, id);
+            rPartitioning.m_partSize[rPartitioning.m_part[id]]++;
+        }
+        else if (!present && occupied(rLive, id))
+        {
+            rPartitioning.m_partSize[rPartitioning.m_part[id]]--;
+            rPartitioning.m_part[id] = noneID_t;
+        }
+
+        if (present && !rLive.m_combinational[id]) { place(rLive, id, noneID_t); }
+        else if (present && !rLive.m_hasLoops) { place(rLive, id, level_from_inputs(rLive, id)); }
+    }
+
+    for (edgeID_t wire : touched) { update_cut(rLive, wire); }
+
+    if (!rLive.m_hasLoops && !relevel(rLive, queue)) { rLive.m_hasLoops = !relevel_all(rLive); }
+    rLive.m_dirty |= rLive.m_hasLoops;
+}
+
+bool SysLive::step(CircuitData& rData, LiveSchedule& rLive)
+{
+    if (rLive.m_dirty)
+    {
+        // Try to leave loop mode first; an edit may have broken the loop.
+        rLive.m_hasLoops = !relevel_all(rLive);
+        if (rLive.m_hasLoops) { rLive.m_fallback = SysSchedule::build(rData, rLive.m_maxIterations); }
+        rLive.m_dirty = false;
+    }
+    if (rLive.m_hasLoops) { return SysSchedule::step(rData, rLive.m_fallback); }
+
+    for (nodeID_t id : rLive.m_clocked) { rData.m_nodes[id]->process(rData); }
+    for (nodeID_t id : rLive.m_clocked) { rData.m_nodes[id]->propagate(rData); }
+    for (const std::vector<nodeID_t>& level : rLive.m_levels)
+    {
+        for (nodeID_t id : level) { rData.m_nodes[id]->process(rData); }
+        for (nodeID_t id : level) { rData.m_nodes[id]->propagate(rData); }
+    }
+    return true;
+}
+
+Partitioning SysLive::partitioning(const LiveSchedule& live)
+{
+    Partitioning result = live.m_partitioning;
+    for (edgeID_t wire = 0; wire < live.m_cut.size(); wire++)
+    {
+        if (live.m_cut[wire]) { result.m_cutWires.push_back(wire); }
+    }
+    return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Partition.h"
+#include "Schedule.h"
+
+// INCREMENTAL SCHEDULE
+
+/**
+ * Levelized evaluation order kept up to date through edits, for tools that change the circuit between clocks. After
+ * adding, removing or rewiring nodes, pass the nodes whose terminals changed to SysLive::update: only their
+ * neighbourhood is revisited, and levels move only where a longest path actually changed. step() runs the same order a
+ * freshly built Schedule would (clocked nodes, then the combinational nodes level by level).
+ *
+ * Combinational loops aren't tracked incrementally. While the logic has one, step() runs a full Schedule, rebuilt on
+ * the first step after each edit, and goes back to incremental mode once an edit breaks the loop.
+ */
+struct LiveSchedule
+{
+    // Adjacency, from Node::terminals()
+    std::vector<std::vector<edgeID_t>> m_inputs;    // per node
+    std::vector<std::vector<edgeID_t>> m_outputs;   // per node
+    std::vector<nodeID_t> m_driver;                 // per wire, nullNode_t if undriven
+    std::vector<std::vector<nodeID_t>> m_readers;   // per wire
+    std::vector<std::vector<uint32_t>> m_readerSlot;    // per node, parallel to m_inputs: index in that wire's m_readers
+    std::vector<std::vector<uint32_t>> m_readerInput;   // per wire, parallel to m_readers: index in the reader's m_inputs
+    std::vector<std::weak_ptr<Node>> m_attached;        // per node, to notice a slot being reused by another node
+
+    // Evaluation order. Nodes within one level don't depend on each other, so their order in a bucket is arbitrary.
+    std::vector<uint8_t> m_combinational;           // per node
+    std::vector<uint32_t> m_level;                  // per node, noneID_t unless combinational and levelized
+    std::vector<uint32_t> m_position;               // per node, index in m_clocked or its level's bucket
+    std::vector<nodeID_t> m_clocked;
+    std::vector<std::vector<nodeID_t>> m_levels;
+
+    // Partition assignment; nodes added later join the part most of their neighbours are in. m_cutWires is left
+    // empty here, SysLive::partitioning fills it from m_cut.
+    Partitioning m_partitioning;
+    std::vector<uint8_t> m_cut;                     // per wire
+
+    bool m_hasLoops{false};
+    bool m_dirty{false};                            // edited since m_fallback was built
+    Schedule m_fallback;
+    uint32_t m_maxIterations{1000};
+
+    // Stats for the last update()
+    uint32_t m_relevelled{0};
+};
+
+namespace SysLive
+{
+// Full build. With numParts > 1 the initial assignment comes from SysPartition::partition.
+LiveSchedule build(CircuitData& rData, uint32_t numParts = 1, uint32_t maxIterations = 1000);
+
+/**
+ * Re-reads the terminals of the given nodes, which may be new, removed (empty slot) or rewired, and repairs adjacency,
+ * levels and partition assignment around them. A connect() between two existing nodes changes both.
+ */
+void update(LiveSchedule& rLive, CircuitData& rData, const std::vector<nodeID_t>& changed);
+
+// One clock. Returns false if a feedback loop didn't settle within the iteration limit.
+bool step(CircuitData& rData, LiveSchedule& rLive);
+
+// The current assignment as a Partitioning, cut wires included.
+Partitioning partitioning(const LiveSchedule& live);
+}
@@ -0,0 +1,312 @@
+#include "LutMap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+namespace
+{
+
+// Truth table of index bit i, over 6 variables.
+constexpr uint64_t s_varTruth[lutMaxInputs_t]
+{
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+};
+
+// Only the first 2^size entries of a table are meaningful.
+uint64_t truth_mask(uint32_t size)
+{
+    return (size >= lutMaxInputs_t) ? ~uint64_t(0) : ((uint64_t(1) << (uint64_t(1) << size)) - 1);
+}
+
+// Truth table of the same function with input i complemented.
+uint64_t flip_input(uint64_t truth, uint32_t i)
+{
+    uint32_t shift = 1u << i;
+    return ((truth & s_varTruth[i]) >> shift) | ((truth & ~s_varTruth[i]) << shift);
+}
+
+struct Cut
+{
+    std::array<uint32_t, lutMaxInputs_t> m_leaves;
+    uint32_t m_size;
+    uint32_t m_depth;
+    float m_areaFlow;
+};
+
+constexpr size_t c_cutsPerVar = 8;
+
+bool merge_cuts(const Cut& a, const Cut& b, uint32_t k, Cut& rOut)
+{
+    uint32_t i = 0, j = 0, n = 0;
+    while (i < a.m_size || j < b.m_size)
+    {
+        uint32_t leaf;
+        if (j == b.m_size || (i < a.m_size && a.m_leaves[i] < b.m_leaves[j])) { leaf = a.m_leaves[i++]; }
+        else if (i == a.m_size || b.m_leaves[j] < a.m_leaves[i]) { leaf = b.m_leaves[j++]; }
+        else { leaf = a.m_leaves[i++]; j++; }
+
+        if (n == k) { return false; }
+        rOut.m_leaves[n++] = leaf;
+    }
+    rOut.m_size = n;
+    return true;
+}
+
+} // namespace
+
+uint64_t SysLut::cone_truth(const AigData& aig, uint32_t var, const uint32_t* pLeaves, uint32_t size)
+{
+    std::unordered_map<uint32_t, uint64_t> values;
+    values.emplace(0, 0);
+    for (uint32_t i = 0; i < size; i++) { values[pLeaves[i]] = s_varTruth[i]; }
+
+    uint32_t firstAnd = 1 + aig.m_numInputs;
+    std::vector<uint32_t> stack{var};
+    while (!stack.empty())
+    {
+        uint32_t top = stack.back();
+        if (values.count(top)) { stack.pop_back(); continue; }
+
+        // Anything else reached below the cut must be an AND inside the cone.
+        assert(top >= firstAnd);
+        const AigAnd& gate = aig.m_ands[top - firstAnd];
+        auto a = values.find(aig_var(gate.m_inA));
+        auto b = values.find(aig_var(gate.m_inB));
+        if (a == values.end()) { stack.push_back(aig_var(gate.m_inA)); continue; }
+        if (b == values.end()) { stack.push_back(aig_var(gate.m_inB)); continue; }
+
+        uint64_t valA = a->second ^ (uint64_t(0) - uint64_t(aig_is_compl(gate.m_inA)));
+        uint64_t valB = b->second ^ (uint64_t(0) - uint64_t(aig_is_compl(gate.m_inB)));
+        values[top] = valA & valB;
+        stack.pop_back();
+    }
+    return values[var] & truth_mask(size);
+}
+
+LutMapping SysLut::map_aig(const AigData& aig, const std::vector<uint32_t>& roots, uint32_t k)
+{
+    assert(k >= 2 && k <= lutMaxInputs_t);
+
+    uint32_t numVars = aig.num_vars();
+    uint32_t firstAnd = 1 + aig.m_numInputs;
+
+    std::vector<uint32_t> refs(numVars, 0);
+    for (const AigAnd& gate : aig.m_ands)
+    {
+        refs[aig_var(gate.m_inA)]++;
+        refs[aig_var(gate.m_inB)]++;
+    }
+
+    std::vector<std::vector<Cut>> cuts(numVars);
+    std::vector<uint32_t> depth(numVars, 0);
+    std::vector<float> areaFlow(numVars, 0.0f);
+
+    auto trivial = [](uint32_t var)
+    {
+        Cut cut{};
+        cut.m_leaves[0] = var;
+        cut.m_size = 1;
+        return cut;
+    };
+
+    for (uint32_t var = 1; var < firstAnd; var++) { cuts[var].push_back(trivial(var)); }
+
+    std::vector<Cut> candidates;
+    for (uint32_t var = firstAnd; var < numVars; var++)
+    {
+        const AigAnd& gate = aig.m_ands[var - firstAnd];
+        candidates.clear();
+        for (const Cut& a : cuts[aig_var(gate.m_inA)])
+        {
+            for (const Cut& b : cuts[aig_var(gate.m_inB)])
+            {
+                Cut merged;
+                if (!merge_cuts(a, b, k, merged)) { continue; }
+
+                auto same = [&merged](const Cut& c)
+                {
+                    return c.m_size == merged.m_size
+                        && std::equal(c.m_leaves.begin(), c.m_leaves.begin() + c.m_size, merged.m_leaves.begin());
+                };
+                if (std::any_of(candidates.begin(), candidates.end(), same)) { continue; }
+
+                merged.m_depth = 0;
+                merged.m_areaFlow = 1.0f;
+                for (uint32_t i = 0; i < merged.m_size; i++)
+                {
+                    merged.m_depth = std::max(merged.m_depth, depth[merged.m_leaves[i]]);
+                    merged.m_areaFlow += areaFlow[merged.m_leaves[i]];
+                }
+                merged.m_depth++;
+                merged.m_areaFlow /= float(std::max(refs[var], 1u));
+                candidates.push_back(merged);
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Cut& a, const Cut& b)
+        {
+            if (a.m_depth != b.m_depth) { return a.m_depth < b.m_depth; }
+            if (a.m_areaFlow != b.m_areaFlow) { return a.m_areaFlow < b.m_areaFlow; }
+            return a.m_size < b.m_size;
+        });
+        if (candidates.size() > c_cutsPerVar) { candidates.resize(c_cutsPerVar); }
+
+        // Best non-trivial cut first, trivial cut last so fanouts can still stop here.
+        depth[var] = candidates.front().m_depth;
+        areaFlow[var] = candidates.front().m_areaFlow;
+        cuts[var] = candidates;
+        cuts[var].push_back(trivial(var));
+    }
+
+    // Cover: walk back from the roots through the leaves of each chosen cut.
+    std::vector<bool> used(numVars, false);
+    std::vector<uint32_t> stack;
+    for (uint32_t root : roots)
+    {
+        if (root >= firstAnd && !used[root]) { used[root] = true; stack.push_back(root); }
+    }
+    while (!stack.empty())
+    {
+        const Cut& best = cuts[stack.back()].front();
+        stack.pop_back();
+        for (uint32_t i = 0; i < best.m_size; i++)
+        {
+            uint32_t leaf = best.m_leaves[i];
+            if (leaf >= firstAnd && !used[leaf]) { used[leaf] = true; stack.push_back(leaf); }
+        }
+    }
+
+    LutMapping mapping;
+    for (uint32_t var = firstAnd; var < numVars; var++)
+    {
+        if (!used[var]) { continue; }
+
+        const Cut& best = cuts[var].front();
+        LutCell cell;
+        cell.m_root = var;
+        cell.m_size = best.m_size;
+        std::copy(best.m_leaves.begin(), best.m_leaves.begin() + best.m_size, cell.m_leaves.begin());
+        cell.m_truth = cone_truth(aig, var, cell.m_leaves.data(), cell.m_size);
+        mapping.m_cells.push_back(cell);
+        mapping.m_depth = std::max(mapping.m_depth, best.m_depth);
+    }
+    return mapping;
+}
+
+size_t SysLut::map(CircuitData& rData, uint32_t k)
+{
+    AigData aig = SysAig::extract(rData);
+
+    // Wires that something other than a gate reads must keep being driven.
+    std::vector<bool> readOutside(rData.m_edges.size(), false);
+    for (auto& node : rData.m_nodes)
+    {
+        if (!node || dynamic_cast<ANDGate*>(node.get())) { continue; }
+        node->terminals([&readOutside](edgeID_t& rWire, bool isOutput)
+        {
+            if (!isOutput) { readOutside[rWire] = true; }
+        });
+    }
+
+    // Loop cuts are AIG inputs and AIG outputs at the same time; they must stay too.
+    std::vector<bool> isInput(rData.m_edges.size(), false);
+    for (edgeID_t wire : aig.m_inputWires) { isInput[wire] = true; }
+
+    std::vector<size_t> keptOutputs;
+    std::vector<uint32_t> roots;
+    for (size_t i = 0; i < aig.m_outputs.size(); i++)
+    {
+        edgeID_t wire = aig.m_outputWires[i];
+        if (wire != nullEdge_t && (readOutside[wire] || isInput[wire]))
+        {
+            keptOutputs.push_back(i);
+            roots.push_back(aig_var(aig.m_outputs[i]));
+        }
+    }
+
+    LutMapping mapping = map_aig(aig, roots, k);
+
+    for (auto& node : rData.m_nodes)
+    {
+        if (dynamic_cast<ANDGate*>(node.get())) { node.reset(); }
+    }
+
+    // Every variable a LUT reads needs a wire. Inputs already have one; each mapped root gets either a
+    // kept output wire (in whatever polarity that wire carries) or a fresh one.
+    std::vector<edgeID_t> wireOf(aig.num_vars(), nullEdge_t);
+    std::vector<bool> wireCompl(aig.num_vars(), false);
+    for (uint32_t i = 0; i < aig.m_numInputs; i++) { wireOf[1 + i] = aig.m_inputWires[i]; }
+
+    std::vector<size_t> extraOutputs;
+    for (size_t i : keptOutputs)
+    {
+        aigLit_t lit = aig.m_outputs[i];
+        uint32_t var = aig_var(lit);
+        if (var > aig.m_numInputs && wireOf[var] == nullEdge_t)
+        {
+            wireOf[var] = aig.m_outputWires[i];
+            wireCompl[var] = aig_is_compl(lit);
+        }
+        else
+        {
+            extraOutputs.push_back(i);
+        }
+    }
+
+    auto new_wire = [&rData]()
+    {
+        edgeID_t id = edgeID_t(rData.m_edges.size());
+        rData.m_edges.emplace_back(std::make_shared<WireNode<bool>>());
+        return id;
+    };
+
+    size_t added = 0;
+    auto add_lut = [&](edgeID_t out, uint32_t size, const uint32_t* pLeaves, uint64_t truth)
+    {
+        auto lut = rData.get<LUT>(rData.add<LUT>());
+        lut->m_size = size;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            lut->m_inputs[i].m_id = wireOf[pLeaves[i]];
+            if (wireCompl[pLeaves[i]]) { truth = flip_input(truth, i); }
+        }
+        lut->m_truth = truth & truth_mask(size);
+        lut->m_output.m_id = out;
+        static_cast<WireNode<bool>&>(*rData.m_edges[out]).m_in = rData.m_nodes.size() - 1;
+        added++;
+    };
+
+    std::vector<const LutCell*> cellOf(aig.num_vars(), nullptr);
+    for (const LutCell& cell : mapping.m_cells)
+    {
+        cellOf[cell.m_root] = &cell;
+        if (wireOf[cell.m_root] == nullEdge_t) { wireOf[cell.m_root] = new_wire(); }
+        uint64_t truth = wireCompl[cell.m_root] ? ~cell.m_truth : cell.m_truth;
+        add_lut(wireOf[cell.m_root], cell.m_size, cell.m_leaves.data(), truth);
+    }
+
+    // Further outputs of a mapped root get their own copy of its LUT, with the polarity folded into the table, so they
+    // switch in the same clock as the first. Constants and plain inputs get a buffer.
+    for (size_t i : extraOutputs)
+    {
+        aigLit_t lit = aig.m_outputs[i];
+        uint32_t var = aig_var(lit);
+        if (const LutCell* pCell = cellOf[var])
+        {
+            uint64_t truth = aig_is_compl(lit) ? ~pCell->m_truth : pCell->m_truth;
+            add_lut(aig.m_outputWires[i], pCell->m_size, pCell->m_leaves.data(), truth);
+        }
+        else if (var == 0)
+        {
+            add_lut(aig.m_outputWires[i], 0, nullptr, aig_is_compl(lit) ? 1 : 0);
+        }
+        else
+        {
+            add_lut(aig.m_outputWires[i], 1, &var, aig_is_compl(lit) ? 0x1 : 0x2);
+        }
+    }
+
+    return added;
+}
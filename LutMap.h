@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Aig.h"
+
+// LUT MAPPING
+
+// Cuts are limited to lutMaxInputs_t leaves (Nodes.h), the widest LUT node.
+
+/**
+ * One k-feasible cut chosen to implement an AIG variable. Leaves are AIG variables; leaf i is bit i
+ * of the index into m_truth.
+ */
+struct LutCell
+{
+    uint32_t m_root{0};
+    uint32_t m_size{0};
+    std::array<uint32_t, lutMaxInputs_t> m_leaves{};
+    uint64_t m_truth{0};
+};
+
+struct LutMapping
+{
+    // Topological order: every cell comes after the cells for its leaves.
+    std::vector<LutCell> m_cells;
+    uint32_t m_depth{0};
+};
+
+namespace SysLut
+{
+// Covers the cones of the given root variables with cuts of at most k leaves. Cuts are ranked by
+// depth first, then by area flow, keeping a handful of priority cuts per variable.
+LutMapping map_aig(const AigData& aig, const std::vector<uint32_t>& roots, uint32_t k = lutMaxInputs_t);
+
+// Replaces the ANDGates in the circuit with LUT nodes. Wires read by anything other than an ANDGate
+// are kept and driven by a LUT; wires internal to a cone are dropped. Like SysAig::absorb, the mapped
+// cones are treated as combinational logic, so each cone now takes one cycle instead of one per gate.
+// Returns the number of LUT nodes added.
+size_t map(CircuitData& rData, uint32_t k = lutMaxInputs_t);
+
+// Truth table of the cone rooted at var, with leaf i assigned to index bit i.
+uint64_t cone_truth(const AigData& aig, uint32_t var, const uint32_t* pLeaves, uint32_t size);
+}
@@ -0,0 +1,106 @@
+#include "Netlist.h"
+
+#include <algorithm>
+#include <cstring>
+
+NetlistGraph SysNetlist::build(CircuitData& rData)
+{
+    NetlistGraph graph;
+    size_t numNodes = rData.m_nodes.size();
+    size_t numWires = rData.m_edges.size();
+
+    graph.m_driver.assign(numWires, nullNode_t);
+    graph.m_inputStart.assign(numNodes + 1, 0);
+    graph.m_outputStart.assign(numNodes + 1, 0);
+    std::vector<uint32_t> readerCount(numWires, 0);
+
+    for (nodeID_t id = 0; id < numNodes; id++)
+    {
+        graph.m_inputStart[id] = uint32_t(graph.m_inputs.size());
+        graph.m_outputStart[id] = uint32_t(graph.m_outputs.size());
+        if (!rData.m_nodes[id]) { continue; }
+
+        rData.m_nodes[id]->terminals([&](edgeID_t& rWire, bool isOutput)
+        {
+            if (rWire == nullEdge_t) { return; }
+            if (isOutput)
+            {
+                graph.m_outputs.push_back(rWire);
+                graph.m_driver[rWire] = id;
+            }
+            else
+            {
+                graph.m_inputs.push_back(rWire);
+                readerCount[rWire]++;
+            }
+        });
+    }
+    graph.m_inputStart[numNodes] = uint32_t(graph.m_inputs.size());
+    graph.m_outputStart[numNodes] = uint32_t(graph.m_outputs.size());
+
+    graph.m_readerStart.assign(numWires + 1, 0);
+    for (size_t wire = 0; wire < numWires; wire++)
+    {
+        graph.m_readerStart[wire + 1] = graph.m_readerStart[wire] + readerCount[wire];
+    }
+    graph.m_readers.resize(graph.m_inputs.size());
+
+    std::vector<uint32_t> fill(graph.m_readerStart.begin(), graph.m_readerStart.end() - 1);
+    for (nodeID_t id = 0; id < numNodes; id++)
+    {
+        for (uint32_t i = graph.m_inputStart[id]; i < graph.m_inputStart[id + 1]; i++)
+        {
+            graph.m_readers[fill[graph.m_inputs[i]]++] = id;
+        }
+    }
+    return graph;
+}
+
+void SysNetlist::successors(const NetlistGraph& graph, nodeID_t node, std::vector<nodeID_t>& rOut)
+{
+    for (uint32_t i = graph.m_outputStart[node]; i < graph.m_outputStart[node + 1]; i++)
+    {
+        edgeID_t wire = graph.m_outputs[i];
+        rOut.insert(rOut.end(), graph.m_readers.begin() + graph.m_readerStart[wire],
+            graph.m_readers.begin() + graph.m_readerStart[wire + 1]);
+    }
+}
+
+WireSnapshot SysNetlist::snapshot(CircuitData& rData, const std::vector<edgeID_t>& wires)
+{
+    size_t numWires = rData.m_edges.size();
+    std::vector<uint32_t> size(numWires, 0);
+    for (edgeID_t wire : wires)
+    {
+        if (wire != nullEdge_t && rData.m_edges[wire]) { size[wire] = uint32_t(rData.m_edges[wire]->packed_size()); }
+    }
+
+    WireSnapshot snapshot;
+    snapshot.m_offset.assign(numWires + 1, 0);
+    uint32_t largest = 0;
+    for (size_t wire = 0; wire < numWires; wire++)
+    {
+        snapshot.m_offset[wire + 1] = snapshot.m_offset[wire] + size[wire];
+        largest = std::max(largest, size[wire]);
+    }
+    snapshot.m_bytes.resize(snapshot.m_offset[numWires]);
+    snapshot.m_scratch.resize(largest);
+    for (size_t wire = 0; wire < numWires; wire++)
+    {
+        if (size[wire]) { rData.m_edges[wire]->pack(snapshot.m_bytes.data() + snapshot.m_offset[wire]); }
+    }
+    return snapshot;
+}
+
+bool SysNetlist::latch(CircuitData& rData, WireSnapshot& rSnapshot, edgeID_t wire)
+{
+    uint32_t first = rSnapshot.m_offset[wire];
+    uint32_t size = rSnapshot.m_offset[wire + 1] - first;
+    const Connection& connection = *rData.m_edges[wire];
+    if (size == 0 || connection.packed_size() != size) { return true; }
+
+    connection.pack(rSnapshot.m_scratch.data());
+    if (std::memcmp(rSnapshot.m_scratch.data(), rSnapshot.m_bytes.data() + first, size) == 0) { return false; }
+    std::memcpy(rSnapshot.m_bytes.data() + first, rSnapshot.m_scratch.data(), size);
+    return true;
+}
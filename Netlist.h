@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Nodes.h"
+
+// NETLIST ADJACENCY
+
+/**
+ * Who drives and who reads each wire, gathered from Node::terminals(). Lists are stored CSR style: the entries for
+ * index i are [start[i], start[i + 1]).
+ */
+struct NetlistGraph
+{
+    std::vector<nodeID_t> m_driver;         // per wire, nullNode_t if undriven
+
+    std::vector<uint32_t> m_readerStart;    // per wire
+    std::vector<nodeID_t> m_readers;
+
+    std::vector<uint32_t> m_inputStart;     // per node
+    std::vector<edgeID_t> m_inputs;
+
+    std::vector<uint32_t> m_outputStart;    // per node
+    std::vector<edgeID_t> m_outputs;
+
+    size_t num_nodes() const { return m_inputStart.empty() ? 0 : m_inputStart.size() - 1; }
+    size_t num_wires() const { return m_driver.size(); }
+};
+
+/**
+ * Last seen value of some wires, as Connection::pack images, for telling whether an evaluation changed them. Each
+ * user keeps its own, so SysDelta and SysSchedule can run on the same circuit without confusing each other's change
+ * detection. Wires not listed, or that can't be packed, always count as changed.
+ */
+struct WireSnapshot
+{
+    std::vector<uint32_t> m_offset;         // per wire + 1, into m_bytes; a wire's image is [m_offset[w], m_offset[w + 1])
+    std::vector<uint8_t> m_bytes;
+    std::vector<uint8_t> m_scratch;
+};
+
+namespace SysNetlist
+{
+NetlistGraph build(CircuitData& rData);
+
+// Nodes reading any wire that node writes, i.e. the node's successors. May contain duplicates.
+void successors(const NetlistGraph& graph, nodeID_t node, std::vector<nodeID_t>& rOut);
+
+// Snapshot of the given wires' current values.
+WireSnapshot snapshot(CircuitData& rData, const std::vector<edgeID_t>& wires);
+
+// Records the wire's current value, returning whether it differs from the one recorded before.
+bool latch(CircuitData& rData, WireSnapshot& rSnapshot, edgeID_t wire);
+}
@@ -1,5 +1,38 @@
 #include "Nodes.h"
 
+#include <cstring>
+
+#include "CodeGen.h"
+
+namespace
+{
+
+template <typename T>
+std::string literal_from(const Connection& wire)
+{
+    T value{};
+    if (wire.packed_size() == sizeof(T)) { wire.pack(&value); }
+    return cpp_literal(value);
+}
+
+struct LiteralFormat
+{
+    const char* m_type;
+    std::string (*m_format)(const Connection&);
+};
+
+constexpr LiteralFormat c_formats[] = {
+    {cpp_type<bool>(), &literal_from<bool>},
+    {cpp_type<uint8_t>(), &literal_from<uint8_t>},
+    {cpp_type<uint16_t>(), &literal_from<uint16_t>},
+    {cpp_type<uint32_t>(), &literal_from<uint32_t>},
+    {cpp_type<uint64_t>(), &literal_from<uint64_t>},
+    {cpp_type<int32_t>(), &literal_from<int32_t>},
+    {cpp_type<int64_t>(), &literal_from<int64_t>},
+};
+
+} // namespace
+
 void SysCircuit::process_all(CircuitData& rData)
 {
     for (auto& node : rData.m_nodes)
@@ -15,3 +48,100 @@ void SysCircuit::propagate_all(CircuitData& rData)
         if (node) { node->propagate(rData); }
     }
 }
+
+std::string CodeWriter::wire(edgeID_t id, const char* type)
+{
+    if (type == nullptr || id == nullEdge_t || !m_rData.m_edges.at(id)) { return declare_wire(id, type, "{}"); }
+    for (const LiteralFormat& format : c_formats)
+    {
+        if (std::strcmp(format.m_type, type) == 0) { return declare_wire(id, type, format.m_format(*m_rData.m_edges[id])); }
+    }
+    return declare_wire(id, type, "{}");
+}
+
+std::string CodeWriter::declare_wire(edgeID_t id, const char* type, const std::string& init)
+{
+    std::string name = "s.w" + std::to_string(id);
+    if (type == nullptr)
+    {
+        m_ok = false;
+        return name;
+    }
+
+    if (m_wireTypes.size() <= id) { m_wireTypes.resize(id + 1, nullptr); }
+    if (m_wireTypes[id] == nullptr)
+    {
+        m_wireTypes[id] = type;
+        m_fields << "    " << type << " w" << id << " = " << init << ";\n";
+    }
+    else if (std::string(m_wireTypes[id]) != type)
+    {
+        m_ok = false;
+    }
+    return name;
+}
+
+std::string CodeWriter::declare_state(const char* field, const char* type, const std::string& init)
+{
+    std::string name = "n" + std::to_string(m_node) + "_" + field;
+    if (type == nullptr)
+    {
+        m_ok = false;
+        return "s." + name;
+    }
+    m_fields << "    " << type << " " << name << " = " << init << ";\n";
+    return "s." + name;
+}
+
+std::string CodeWriter::declare_table(const char* field, const char* type, const std::string& values)
+{
+    std::string name = "n" + std::to_string(m_node) + "_" + field;
+    m_tables << "static const " << type << " " << name << "[] = { " << values << "};\n";
+    return name;
+}
+
+// BUILT-IN NODE EXPORT
+
+bool Constant::generate(CodeWriter& rOut)
+{
+    rOut.propagate(rOut.wire(m_output) + " = " + rOut.state("state", m_state) + ";");
+    return true;
+}
+
+bool ANDGate::generate(CodeWriter& rOut)
+{
+    std::string outVal = rOut.state("outVal", m_outVal);
+    rOut.process(outVal + " = " + rOut.wire(m_inA) + " && " + rOut.wire(m_inB) + ";");
+    rOut.propagate(rOut.wire(m_output) + " = " + outVal + ";");
+    return true;
+}
+
+bool LUT::generate(CodeWriter& rOut)
+{
+    std::string index = "0u";
+    for (uint32_t i = 0; i < m_size; i++)
+    {
+        index += " | (uint32_t(" + rOut.wire(m_inputs[i]) + ") << " + std::to_string(i) + ")";
+    }
+    std::string outVal = rOut.state("outVal", m_outVal);
+    rOut.process(outVal + " = ((" + cpp_literal(m_truth) + " >> (" + index + ")) & 1) != 0;");
+    rOut.propagate(rOut.wire(m_output) + " = " + outVal + ";");
+    return true;
+}
+
+bool SysCodeGen::generate_rom(CodeWriter& rOut, edgeID_t output, const uint32_t* pData, size_t size, uint32_t pc)
+{
+    std::string values;
+    for (size_t i = 0; i < size; i++) { values += cpp_literal(pData[i]) + ", "; }
+    std::string data = rOut.declare_table("data", "uint32_t", values);
+    std::string pcField = rOut.state("pc", pc);
+    rOut.propagate(rOut.wire(output, cpp_type<uint32_t>()) + " = " + data + "[" + pcField + "];");
+    rOut.propagate(pcField + " = (" + pcField + " + 1) % " + std::to_string(size) + ";");
+    return true;
+}
+
+bool SysCodeGen::generate_printer(CodeWriter& rOut, edgeID_t input, const char* type)
+{
+    rOut.process("std::cout << " + rOut.wire(input, type) + " << \"\\n\";");
+    return true;
+}
@@ -4,6 +4,13 @@
 #include <vector>
 #include <memory>
 #include <array>
+#include <functional>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "ChunkedVector.h"
 
 using nodeID_t = uint32_t;
 using edgeID_t = uint32_t;
@@ -11,6 +18,9 @@ using edgeID_t = uint32_t;
 constexpr nodeID_t nullNode_t = uint32_t(0);
 constexpr edgeID_t nullEdge_t = uint32_t(0);
 
+// "No entry" in the per-node and per-wire tables of the graph passes (parts, components, levels, positions).
+constexpr uint32_t noneID_t = UINT32_MAX;
+
 // SYSTEM
 
 struct Connection;
@@ -19,10 +29,21 @@ struct Node;
 template <typename T>
 struct NodeTerminal;
 
+struct CodeWriter;
+
+// Consecutive IDs handed out by one bulk call: m_first, m_first + 1, ..., end() - 1.
+struct IdRange
+{
+    uint32_t end() const { return m_first + m_count; }
+
+    uint32_t m_first{0};
+    uint32_t m_count{0};
+};
+
 struct CircuitData
 {
-    std::vector<std::shared_ptr<Connection>> m_edges{std::shared_ptr<Connection>{}};
-    std::vector<std::shared_ptr<Node>> m_nodes{std::shared_ptr<Node>{}};
+    ChunkedVector<std::shared_ptr<Connection>> m_edges{std::shared_ptr<Connection>{}};
+    ChunkedVector<std::shared_ptr<Node>> m_nodes{std::shared_ptr<Node>{}};
 
     template <typename NODE_T, typename ... ARGS_T>
     nodeID_t add(ARGS_T&& ...args)
@@ -33,6 +54,34 @@ struct CircuitData
         return id;
     }
 
+    /**
+     * Adds count nodes, each constructed from a copy of args, with consecutive IDs. The nodes share one allocation (the
+     * slots hold aliasing pointers into it), which is freed once the last of them is dropped.
+     * Since args are passed as lvalues, nodes that only construct from rvalues (e.g. ROM) need add_n_from.
+     */
+    template <typename NODE_T, typename ... ARGS_T>
+    IdRange add_n(size_t count, const ARGS_T& ...args)
+    {
+        return add_n_from<NODE_T>(count, [&args...](size_t) { return NODE_T(args...); });
+    }
+
+    // add_n with each node returned by make(i), i counting from 0.
+    template <typename NODE_T, typename FACTORY_T>
+    IdRange add_n_from(size_t count, FACTORY_T&& make)
+    {
+        IdRange range{nodeID_t(m_nodes.size()), nodeID_t(count)};
+        m_nodes.reserve(range.end());
+
+        auto pBlock = std::make_shared<std::vector<NODE_T>>();
+        pBlock->reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            NODE_T& rNode = pBlock->emplace_back(make(i));
+            m_nodes.emplace_back(pBlock, &rNode);
+        }
+        return range;
+    }
+
     template <typename NODE_T>
     constexpr std::shared_ptr<NODE_T> get(nodeID_t id)
     {
@@ -59,6 +108,35 @@ void connect(CircuitData& rData, NodeTerminal<TYPE_T>& a, NodeTerminal<TYPE_T>&
     connection->m_out = b.m_parentID;
 }
 
+/**
+ * connect() for a whole list of (source, sink) pairs, with the wires allocated as one block. Pairs that share a source
+ * terminal share its wire, so fanout can be listed pair by pair; the wire's m_out is the first sink listed. A source
+ * gets a new wire even if it was connected before this call. Returns the new wires.
+ */
+template <typename TYPE_T>
+IdRange connect_n(CircuitData& rData, const std::vector<std::pair<NodeTerminal<TYPE_T>*, NodeTerminal<TYPE_T>*>>& pairs)
+{
+    IdRange range{edgeID_t(rData.m_edges.size()), 0};
+    for (auto& [pSource, pSink] : pairs)
+    {
+        bool fresh = pSource->m_id >= range.m_first && pSource->m_id < range.end();
+        if (!fresh) { pSource->m_id = range.m_first + range.m_count++; }
+    }
+    rData.m_edges.reserve(range.end());
+
+    auto pBlock = std::make_shared<std::vector<TYPE_T>>(range.m_count);
+    for (TYPE_T& rWire : *pBlock) { rData.m_edges.emplace_back(pBlock, &rWire); }
+
+    for (auto& [pSource, pSink] : pairs)
+    {
+        TYPE_T& rWire = (*pBlock)[pSource->m_id - range.m_first];
+        pSink->m_id = pSource->m_id;
+        rWire.m_in = pSource->m_parentID;
+        if (rWire.m_out == nullNode_t) { rWire.m_out = pSink->m_parentID; }
+    }
+    return range;
+}
+
 }
 
 // GRAPH COMPS
@@ -71,19 +149,64 @@ struct NodeTerminal
 
     CONNECTION_T& get(CircuitData& rData)
     {
-        return std::static_pointer_cast<CONNECTION_T>(rData.m_edges.at(m_id));
+        // Unconnected (or detached) terminals get a per-thread scratch wire, reset on every call: reads see the default
+        // value, and writes are dropped before any other terminal can see them.
+        if (m_id == nullEdge_t)
+        {
+            static thread_local CONNECTION_T s_unconnected;
+            s_unconnected = CONNECTION_T{};
+            return s_unconnected;
+        }
+        return static_cast<CONNECTION_T&>(*rData.m_edges.at(m_id));
     }
 };
 
+// Called once per terminal with the wire it's attached to. Lets graph passes see (and renumber) the topology.
+using TerminalVisitor = std::function<void(edgeID_t& rWire, bool isOutput)>;
+
 struct Node
 {
     virtual void process(CircuitData& rData) = 0;
     virtual void propagate(CircuitData& rData) = 0;
+    // Every node must report all of its terminals; graph passes can't see a wire a node doesn't list.
+    virtual void terminals(const TerminalVisitor&) = 0;
+
+    // Emits this node as straight-line C++ (see CodeGen.h). Returns false if the node can't be exported.
+    virtual bool generate(CodeWriter&) { return false; }
+
+    // True if the outputs depend only on the current inputs, with no state carried between cycles.
+    // Delta-cycle settling re-evaluates these within a clock; everything else runs once per clock.
+    virtual bool combinational() const { return false; }
+
+    // Copy of the node, terminals included, or nullptr if it can't be copied. Used to move nodes between NUMA nodes.
+    virtual std::shared_ptr<Node> clone() const { return nullptr; }
 };
 
 struct Connection
 {
     typedef void value_type;
+
+    virtual ~Connection() = default;
+
+    // Type-erased copies, used to double-buffer wires that cross between threads and to move wires between NUMA nodes.
+    virtual std::shared_ptr<Connection> clone() const { return nullptr; }
+    virtual void copy_from(const Connection&) {}
+
+    // Flat byte image of the value, for wires shipped between processes and for change detection (WireSnapshot).
+    // packed_size() is 0 if it can't be flattened.
+    virtual size_t packed_size() const { return 0; }
+    virtual void pack(void*) const {}
+    virtual void unpack(const void*) {}
+
+    // Copy-constructs the wire into caller-provided memory of at least storage_size() bytes, aligned to
+    // storage_align(). Lets a wire arena lay wires out itself; storage_size() is 0 if the wire can't be placed.
+    virtual size_t storage_size() const { return 0; }
+    virtual size_t storage_align() const { return 1; }
+    virtual Connection* copy_to(void*) const { return nullptr; }
+
+    // Endpoints recorded by SysCircuit::connect.
+    nodeID_t m_in{nullNode_t};
+    nodeID_t m_out{nullNode_t};
 };
 
 template <typename DATA_T>
@@ -91,12 +214,47 @@ struct WireNode : Connection
 {
     typedef DATA_T value_type;
 
+    std::shared_ptr<Connection> clone() const override { return std::make_shared<WireNode<DATA_T>>(*this); }
+    void copy_from(const Connection& other) override { m_value = static_cast<const WireNode<DATA_T>&>(other).m_value; }
+
+    size_t packed_size() const override { return std::is_trivially_copyable_v<DATA_T> ? sizeof(DATA_T) : 0; }
+    void pack(void* pOut) const override
+    {
+        if constexpr (std::is_trivially_copyable_v<DATA_T>) { std::memcpy(pOut, &m_value, sizeof(DATA_T)); }
+    }
+    void unpack(const void* pIn) override
+    {
+        if constexpr (std::is_trivially_copyable_v<DATA_T>) { std::memcpy(&m_value, pIn, sizeof(DATA_T)); }
+    }
+
+    size_t storage_size() const override { return sizeof(WireNode<DATA_T>); }
+    size_t storage_align() const override { return alignof(WireNode<DATA_T>); }
+    Connection* copy_to(void* pMemory) const override { return new (pMemory) WireNode<DATA_T>(*this); }
+
     DATA_T m_value{};
-    nodeID_t m_in{nullNode_t};
-    nodeID_t m_out{nullNode_t};
 };
 
 
+// CODE GENERATION
+
+// Spelling of a wire or state type in generated code; nullptr if it can't be exported.
+template <typename T> constexpr const char* cpp_type() { return nullptr; }
+template <> constexpr const char* cpp_type<bool>() { return "bool"; }
+template <> constexpr const char* cpp_type<uint8_t>() { return "uint8_t"; }
+template <> constexpr const char* cpp_type<uint16_t>() { return "uint16_t"; }
+template <> constexpr const char* cpp_type<uint32_t>() { return "uint32_t"; }
+template <> constexpr const char* cpp_type<uint64_t>() { return "uint64_t"; }
+template <> constexpr const char* cpp_type<int32_t>() { return "int32_t"; }
+template <> constexpr const char* cpp_type<int64_t>() { return "int64_t"; }
+
+// The writer itself is in CodeGen.h. The built-in nodes' generate() bodies are in Nodes.cpp, the template ones behind
+// these, so that this header doesn't need it.
+namespace SysCodeGen
+{
+bool generate_rom(CodeWriter& rOut, edgeID_t output, const uint32_t* pData, size_t size, uint32_t pc);
+bool generate_printer(CodeWriter& rOut, edgeID_t input, const char* type);
+}
+
 // Example nodes
 
 struct Constant : public Node
@@ -104,6 +262,12 @@ struct Constant : public Node
     void process(CircuitData&) {}
     void propagate(CircuitData& rData) { m_output.get(rData).m_value = m_state; }
 
+    void terminals(const TerminalVisitor& visit) override { visit(m_output.m_id, true); }
+
+    std::shared_ptr<Node> clone() const override { return std::make_shared<Constant>(*this); }
+
+    bool generate(CodeWriter& rOut) override;
+
     bool m_state{false};
     NodeTerminal<WireNode<bool>> m_output;
 };
@@ -120,6 +284,19 @@ struct ANDGate : public Node
         m_output.get(rData).m_value = m_outVal;
     }
 
+    void terminals(const TerminalVisitor& visit) override
+    {
+        visit(m_inA.m_id, false);
+        visit(m_inB.m_id, false);
+        visit(m_output.m_id, true);
+    }
+
+    std::shared_ptr<Node> clone() const override { return std::make_shared<ANDGate>(*this); }
+
+    bool generate(CodeWriter& rOut) override;
+
+    bool combinational() const override { return true; }
+
     NodeTerminal<WireNode<bool>> m_inA;
     NodeTerminal<WireNode<bool>> m_inB;
     NodeTerminal<WireNode<bool>> m_output;
@@ -127,6 +304,47 @@ struct ANDGate : public Node
     bool m_outVal{false};
 };
 
+// Widest LUT the simulator (and so the mapper) supports; m_truth holds 2^lutMaxInputs_t bits.
+constexpr uint32_t lutMaxInputs_t = 6;
+
+// Up to lutMaxInputs_t-input lookup table. Input i is bit i of the index into m_truth.
+struct LUT : public Node
+{
+    void process(CircuitData& rData) override
+    {
+        uint32_t index = 0;
+        for (uint32_t i = 0; i < m_size; i++)
+        {
+            index |= uint32_t(m_inputs[i].get(rData).m_value) << i;
+        }
+        m_outVal = ((m_truth >> index) & 1) != 0;
+    }
+
+    void propagate(CircuitData& rData) override
+    {
+        m_output.get(rData).m_value = m_outVal;
+    }
+
+    void terminals(const TerminalVisitor& visit) override
+    {
+        for (uint32_t i = 0; i < m_size; i++) { visit(m_inputs[i].m_id, false); }
+        visit(m_output.m_id, true);
+    }
+
+    std::shared_ptr<Node> clone() const override { return std::make_shared<LUT>(*this); }
+
+    bool generate(CodeWriter& rOut) override;
+
+    bool combinational() const override { return true; }
+
+    std::array<NodeTerminal<WireNode<bool>>, lutMaxInputs_t> m_inputs;
+    NodeTerminal<WireNode<bool>> m_output;
+
+    uint64_t m_truth{0};
+    uint32_t m_size{0};
+    bool m_outVal{false};
+};
+
 template <size_t SIZE>
 struct ROM : public Node
 {
@@ -143,6 +361,15 @@ struct ROM : public Node
         (++m_pc) %= SIZE;
     }
 
+    void terminals(const TerminalVisitor& visit) override { visit(m_output.m_id, true); }
+
+    std::shared_ptr<Node> clone() const override { return std::make_shared<ROM<SIZE>>(*this); }
+
+    bool generate(CodeWriter& rOut) override
+    {
+        return SysCodeGen::generate_rom(rOut, m_output.m_id, m_data.data(), SIZE, m_pc);
+    }
+
     void jmp(uint32_t addr) { m_pc = addr; }
 
     std::array<uint32_t, SIZE> m_data;
@@ -161,5 +388,14 @@ struct Printer : public Node
 
     void propagate(CircuitData&) override {}
 
+    void terminals(const TerminalVisitor& visit) override { visit(m_input.m_id, false); }
+
+    std::shared_ptr<Node> clone() const override { return std::make_shared<Printer<DATA_T>>(*this); }
+
+    bool generate(CodeWriter& rOut) override
+    {
+        return SysCodeGen::generate_printer(rOut, m_input.m_id, cpp_type<DATA_T>());
+    }
+
     NodeTerminal<WireNode<DATA_T>> m_input;
 };
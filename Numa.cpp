@@ -0,0 +1,162 @@
+#include "Numa.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace
+{
+
+constexpr uint32_t c_maxNodes = 1024;
+
+std::vector<uint32_t> allowed_cpus()
+{
+    std::vector<uint32_t> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set)) { cpus.push_back(cpu); }
+        }
+    }
+    if (cpus.empty())
+    {
+        for (uint32_t cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); cpu++) { cpus.push_back(cpu); }
+    }
+    return cpus;
+}
+
+} // namespace
+
+std::vector<uint32_t> SysNuma::parse_cpu_list(const std::string& list)
+{
+    std::vector<uint32_t> cpus;
+    std::stringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ','))
+    {
+        size_t dash = range.find('-');
+        try
+        {
+            uint32_t first = uint32_t(std::stoul(range.substr(0, dash)));
+            uint32_t last = (dash == std::string::npos) ? first : uint32_t(std::stoul(range.substr(dash + 1)));
+            for (uint32_t cpu = first; cpu <= last; cpu++) { cpus.push_back(cpu); }
+        }
+        catch (const std::exception&)
+        {
+            // Blank or malformed entry, e.g. the trailing newline.
+        }
+    }
+    return cpus;
+}
+
+NumaTopology SysNuma::topology()
+{
+    std::vector<uint32_t> allowed = allowed_cpus();
+    NumaTopology result;
+    for (uint32_t node = 0; node < c_maxNodes; node++)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file)
+        {
+            if (node == 0) { break; }
+            continue;
+        }
+        std::string list;
+        std::getline(file, list);
+
+        std::vector<uint32_t> cpus;
+        for (uint32_t cpu : parse_cpu_list(list))
+        {
+            if (std::binary_search(allowed.begin(), allowed.end(), cpu)) { cpus.push_back(cpu); }
+        }
+        if (cpus.empty()) { continue; }
+        result.m_nodeIds.push_back(node);
+        result.m_nodeCpus.push_back(std::move(cpus));
+    }
+
+    if (result.m_nodeIds.empty())
+    {
+        result.m_nodeIds.push_back(0);
+        result.m_nodeCpus.push_back(std::move(allowed));
+    }
+    return result;
+}
+
+NumaPlacement SysNuma::place(const NumaTopology& topology, uint32_t numWorkers)
+{
+    NumaPlacement placement;
+    size_t numNodes = std::max<size_t>(topology.num_nodes(), 1);
+    for (uint32_t worker = 0; worker < numWorkers; worker++)
+    {
+        uint32_t node = uint32_t(uint64_t(worker) * numNodes / numWorkers);
+        placement.m_workerNode.push_back(node);
+        placement.m_workerCpus.push_back(node < topology.num_nodes() ? topology.m_nodeCpus[node] : std::vector<uint32_t>{});
+    }
+    return placement;
+}
+
+bool SysNuma::pin_current_thread(const std::vector<uint32_t>& cpus)
+{
+    if (cpus.empty()) { return false; }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE) { CPU_SET(cpu, &set); }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+std::vector<uint32_t> SysNuma::thread_cpus()
+{
+    std::vector<uint32_t> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    {
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set)) { cpus.push_back(cpu); }
+        }
+    }
+    return cpus;
+}
+
+void SysNuma::relocate(CircuitData& rData, const Partitioning& partitioning, const NumaPlacement& placement)
+{
+    NetlistGraph graph = SysNetlist::build(rData);
+    std::vector<std::vector<nodeID_t>> nodes(partitioning.m_numParts);
+    for (nodeID_t id = 0; id < partitioning.m_part.size(); id++)
+    {
+        if (partitioning.m_part[id] != noneID_t) { nodes[partitioning.m_part[id]].push_back(id); }
+    }
+
+    // Each thread only replaces the m_nodes and m_edges entries of its own part, so they can run side by side.
+    auto rehome = [&rData, &graph, &placement](uint32_t part, const std::vector<nodeID_t>& partNodes)
+    {
+        if (part < placement.m_workerCpus.size()) { SysNuma::pin_current_thread(placement.m_workerCpus[part]); }
+        for (nodeID_t id : partNodes)
+        {
+            if (std::shared_ptr<Node> copy = rData.m_nodes[id]->clone()) { rData.m_nodes[id] = std::move(copy); }
+            for (uint32_t o = graph.m_outputStart[id]; o < graph.m_outputStart[id + 1]; o++)
+            {
+                std::shared_ptr<Connection>& rWire = rData.m_edges[graph.m_outputs[o]];
+                if (std::shared_ptr<Connection> copy = rWire->clone()) { rWire = std::move(copy); }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t part = 0; part < partitioning.m_numParts; part++)
+    {
+        threads.emplace_back(rehome, part, std::cref(nodes[part]));
+    }
+    for (std::thread& thread : threads) { thread.join(); }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Partition.h"
+
+// NUMA PLACEMENT
+
+// CPUs of each NUMA node that this process may run on. Nodes without any such CPU are left out.
+struct NumaTopology
+{
+    std::vector<uint32_t> m_nodeIds;                // as numbered by the kernel
+    std::vector<std::vector<uint32_t>> m_nodeCpus;
+
+    size_t num_nodes() const { return m_nodeIds.size(); }
+};
+
+/**
+ * Where each worker of a parallel run lives: the NUMA node its nodes and wires are allocated on and the CPUs its
+ * thread is pinned to. Index i is part i of a Partitioning, or worker i of a ComponentPlan. Workers with no CPUs listed
+ * aren't pinned; m_workerCpus can be edited freely after SysNuma::place.
+ */
+struct NumaPlacement
+{
+    std::vector<uint32_t> m_workerNode;             // index into NumaTopology
+    std::vector<std::vector<uint32_t>> m_workerCpus;
+};
+
+namespace SysNuma
+{
+// Reads /sys/devices/system/node. Falls back to one node holding every allowed CPU when that isn't available.
+NumaTopology topology();
+
+// Parses a kernel CPU list such as "0-3,8,10-11".
+std::vector<uint32_t> parse_cpu_list(const std::string& list);
+
+/**
+ * Spreads numWorkers over the topology's nodes in contiguous runs. With parts from SysPartition, the socket boundary
+ * then falls on the top-level cut of the recursive bisection instead of between arbitrary parts. Each worker is
+ * pinned to all CPUs of its node.
+ */
+NumaPlacement place(const NumaTopology& topology, uint32_t numWorkers);
+
+// Pins the calling thread. Returns false if the CPU set is empty or the kernel refused it.
+bool pin_current_thread(const std::vector<uint32_t>& cpus);
+
+// CPUs the calling thread may currently run on.
+std::vector<uint32_t> thread_cpus();
+
+/**
+ * Re-homes each part's node state and the wires its nodes drive on the NUMA node of its worker. One pinned thread per
+ * part clones its nodes and wires (Node::clone, Connection::clone) and swaps the copies into rData, so the memory is
+ * first touched from that node. Nodes or wires that can't be cloned stay where they are. Call this once the circuit is
+ * built, before a parallel run: pointers to the old nodes and wires no longer refer to the ones being simulated.
+ */
+void relocate(CircuitData& rData, const Partitioning& partitioning, const NumaPlacement& placement);
+}
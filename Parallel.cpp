@@ -0,0 +1,238 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+
+uint32_t find_root(std::vector<uint32_t>& rParent, uint32_t x)
+{
+    while (rParent[x] != x)
+    {
+        rParent[x] = rParent[rParent[x]];
+        x = rParent[x];
+    }
+    return x;
+}
+
+// Runs work(0) on the calling thread and work(1..) on new ones, pinned as the placement says. The calling thread gets its
+// own CPU set back afterwards.
+void run_workers(size_t numWorkers, const NumaPlacement* pPlacement, const std::function<void(size_t)>& work)
+{
+    auto pinned = [pPlacement, &work](size_t w)
+    {
+        if (pPlacement && w < pPlacement->m_workerCpus.size()) { SysNuma::pin_current_thread(pPlacement->m_workerCpus[w]); }
+        work(w);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < numWorkers; w++) { threads.emplace_back(pinned, w); }
+    if (numWorkers > 0)
+    {
+        std::vector<uint32_t> callerCpus = pPlacement ? SysNuma::thread_cpus() : std::vector<uint32_t>{};
+        pinned(0);
+        if (!callerCpus.empty()) { SysNuma::pin_current_thread(callerCpus); }
+    }
+    for (std::thread& thread : threads) { thread.join(); }
+}
+
+} // namespace
+
+void SpinBarrier::arrive_and_wait()
+{
+    uint32_t generation = m_generation.load(std::memory_order_acquire);
+    if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count)
+    {
+        m_waiting.store(0, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    while (m_generation.load(std::memory_order_acquire) == generation) { std::this_thread::yield(); }
+}
+
+uint32_t SysParallel::find_components(CircuitData& rData, const NetlistGraph& graph, std::vector<uint32_t>& rComponent)
+{
+    size_t numNodes = graph.num_nodes();
+    std::vector<uint32_t> parent(numNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    auto unite = [&parent](uint32_t a, uint32_t b)
+    {
+        a = find_root(parent, a);
+        b = find_root(parent, b);
+        if (a != b) { parent[std::max(a, b)] = std::min(a, b); }
+    };
+
+    for (edgeID_t wire = 0; wire < graph.num_wires(); wire++)
+    {
+        nodeID_t driver = graph.m_driver[wire];
+        uint32_t first = graph.m_readerStart[wire];
+        uint32_t last = graph.m_readerStart[wire + 1];
+        nodeID_t anchor = (driver != nullNode_t) ? driver : (first != last ? graph.m_readers[first] : nullNode_t);
+        if (anchor == nullNode_t) { continue; }
+
+        for (uint32_t r = first; r < last; r++) { unite(anchor, graph.m_readers[r]); }
+    }
+
+    rComponent.assign(numNodes, noneID_t);
+    std::vector<uint32_t> label(numNodes, noneID_t);
+    uint32_t numComponents = 0;
+    for (nodeID_t id = 0; id < numNodes; id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        uint32_t root = find_root(parent, id);
+        if (label[root] == noneID_t) { label[root] = numComponents++; }
+        rComponent[id] = label[root];
+    }
+    return numComponents;
+}
+
+ComponentPlan SysParallel::plan_components(CircuitData& rData, uint32_t maxThreads)
+{
+    if (maxThreads == 0) { maxThreads = std::max(1u, std::thread::hardware_concurrency()); }
+
+    ComponentPlan plan;
+    NetlistGraph graph = SysNetlist::build(rData);
+    plan.m_numComponents = find_components(rData, graph, plan.m_component);
+
+    std::vector<size_t> size(plan.m_numComponents, 0);
+    for (uint32_t c : plan.m_component)
+    {
+        if (c != noneID_t) { size[c]++; }
+    }
+
+    std::vector<uint32_t> bySize(plan.m_numComponents);
+    std::iota(bySize.begin(), bySize.end(), 0);
+    std::stable_sort(bySize.begin(), bySize.end(), [&size](uint32_t a, uint32_t b) { return size[a] > size[b]; });
+
+    uint32_t numWorkers = std::min(maxThreads, std::max(plan.m_numComponents, 1u));
+    std::vector<size_t> load(numWorkers, 0);
+    std::vector<uint32_t> workerOf(plan.m_numComponents, 0);
+    for (uint32_t c : bySize)
+    {
+        uint32_t worker = uint32_t(std::min_element(load.begin(), load.end()) - load.begin());
+        workerOf[c] = worker;
+        load[worker] += size[c];
+    }
+
+    plan.m_workers.resize(numWorkers);
+    for (nodeID_t id = 0; id < plan.m_component.size(); id++)
+    {
+        if (plan.m_component[id] != noneID_t) { plan.m_workers[workerOf[plan.m_component[id]]].push_back(id); }
+    }
+    return plan;
+}
+
+void SysParallel::run_components(CircuitData& rData, const ComponentPlan& plan, uint64_t cycles,
+    const NumaPlacement* pPlacement)
+{
+    run_workers(plan.m_workers.size(), pPlacement, [&rData, &plan, cycles](size_t w)
+    {
+        const std::vector<nodeID_t>& nodes = plan.m_workers[w];
+        for (uint64_t clk = 0; clk < cycles; clk++)
+        {
+            for (nodeID_t id : nodes) { rData.m_nodes[id]->process(rData); }
+            for (nodeID_t id : nodes) { rData.m_nodes[id]->propagate(rData); }
+        }
+    });
+}
+
+void SysParallel::run_partitioned(CircuitData& rData, const Partitioning& partitioning, uint64_t cycles,
+    const NumaPlacement* pPlacement)
+{
+    struct Boundary
+    {
+        Connection* m_pWire;
+        std::shared_ptr<Connection> m_slots[2];
+    };
+    struct Incoming
+    {
+        Connection* m_pShadow;
+        const Boundary* m_pBoundary;
+    };
+    struct Worker
+    {
+        std::vector<nodeID_t> m_nodes;
+        std::vector<const Boundary*> m_outgoing;
+        std::vector<Incoming> m_incoming;
+    };
+
+    NetlistGraph graph = SysNetlist::build(rData);
+    uint32_t numParts = std::max(partitioning.m_numParts, 1u);
+    std::vector<Worker> workers(numParts);
+    for (nodeID_t id = 0; id < partitioning.m_part.size(); id++)
+    {
+        if (partitioning.m_part[id] != noneID_t) { workers[partitioning.m_part[id]].m_nodes.push_back(id); }
+    }
+
+    // Slots are written by the driving part and shadows by the reading part, so each part's share of them gets its own
+    // cache lines in the arena.
+    auto pArena = std::make_shared<WireArena>();
+    std::vector<Boundary> boundaries(partitioning.m_cutWires.size());
+    std::unordered_map<edgeID_t, const Boundary*> boundaryOf;
+    for (uint32_t part = 0; part < numParts; part++)
+    {
+        pArena->next_line();
+        for (size_t i = 0; i < partitioning.m_cutWires.size(); i++)
+        {
+            edgeID_t wire = partitioning.m_cutWires[i];
+            if (partitioning.m_part[graph.m_driver[wire]] != part) { continue; }
+            boundaries[i].m_pWire = rData.m_edges[wire].get();
+            boundaries[i].m_slots[0] = SysLayout::place(pArena, *rData.m_edges[wire]);
+            boundaries[i].m_slots[1] = SysLayout::place(pArena, *rData.m_edges[wire]);
+            workers[part].m_outgoing.push_back(&boundaries[i]);
+            boundaryOf.emplace(wire, &boundaries[i]);
+        }
+    }
+
+    // Point every cross-part reader at a shadow wire owned by its part. Shadows are appended to m_edges and removed
+    // again at the end, along with the rewiring.
+    size_t numEdges = rData.m_edges.size();
+    std::unordered_map<uint64_t, edgeID_t> shadowOf;
+    std::vector<std::pair<edgeID_t*, edgeID_t>> rewired;
+    for (uint32_t part = 0; part < numParts; part++)
+    {
+        pArena->next_line();
+        for (nodeID_t id : workers[part].m_nodes)
+        {
+            rData.m_nodes[id]->terminals([&](edgeID_t& rWire, bool isOutput)
+            {
+                if (isOutput || rWire == nullEdge_t || graph.m_driver[rWire] == nullNode_t) { return; }
+                if (partitioning.m_part[graph.m_driver[rWire]] == part) { return; }
+
+                uint64_t key = (uint64_t(rWire) << 32) | part;
+                auto found = shadowOf.find(key);
+                if (found == shadowOf.end())
+                {
+                    edgeID_t shadow = edgeID_t(rData.m_edges.size());
+                    rData.m_edges.push_back(SysLayout::place(pArena, *rData.m_edges[rWire]));
+                    workers[part].m_incoming.push_back(Incoming{rData.m_edges[shadow].get(), boundaryOf.at(rWire)});
+                    found = shadowOf.emplace(key, shadow).first;
+                }
+                rewired.emplace_back(&rWire, rWire);
+                rWire = found->second;
+            });
+        }
+    }
+
+    SpinBarrier barrier(numParts);
+    run_workers(numParts, pPlacement, [&rData, &workers, &barrier, cycles](size_t w)
+    {
+        const Worker& worker = workers[w];
+        for (uint64_t clk = 0; clk < cycles; clk++)
+        {
+            for (const Incoming& in : worker.m_incoming) { in.m_pShadow->copy_from(*in.m_pBoundary->m_slots[clk & 1]); }
+            for (nodeID_t id : worker.m_nodes) { rData.m_nodes[id]->process(rData); }
+            for (nodeID_t id : worker.m_nodes) { rData.m_nodes[id]->propagate(rData); }
+            for (const Boundary* pOut : worker.m_outgoing) { pOut->m_slots[(clk + 1) & 1]->copy_from(*pOut->m_pWire); }
+            barrier.arrive_and_wait();
+        }
+    });
+
+    for (auto& [pWire, original] : rewired) { *pWire = original; }
+    rData.m_edges.resize(numEdges);
+}
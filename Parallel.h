@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Layout.h"
+#include "Netlist.h"
+#include "Numa.h"
+#include "Partition.h"
+
+// PARALLEL SIMULATION
+
+/**
+ * Assignment of the circuit's weakly connected components to worker threads. Components share no wires, so each
+ * worker can run its own clock loop over its nodes with no synchronisation at all, and the result is the same as
+ * running process_all/propagate_all on the whole circuit.
+ */
+struct ComponentPlan
+{
+    std::vector<uint32_t> m_component;              // per node, noneID_t for empty slots
+    uint32_t m_numComponents{0};
+    std::vector<std::vector<nodeID_t>> m_workers;   // nodes of each worker, in m_nodes order
+};
+
+// Reusable barrier for a fixed number of threads. Spins with yield, since a cycle is usually short.
+struct SpinBarrier
+{
+    SpinBarrier(uint32_t count) : m_count(count) {}
+
+    void arrive_and_wait();
+
+    uint32_t m_count;
+    std::atomic<uint32_t> m_waiting{0};
+    std::atomic<uint32_t> m_generation{0};
+};
+
+namespace SysParallel
+{
+// Labels every node with its weakly connected component (union-find over shared wires).
+uint32_t find_components(CircuitData& rData, const NetlistGraph& graph, std::vector<uint32_t>& rComponent);
+
+// Finds the components and packs them onto at most maxThreads workers, largest first onto the least loaded worker.
+// maxThreads == 0 means std::thread::hardware_concurrency().
+ComponentPlan plan_components(CircuitData& rData, uint32_t maxThreads = 0);
+
+// Runs each worker's clock loop on its own thread for the given number of cycles, and joins. With a placement, worker i's
+// thread is pinned to placement.m_workerCpus[i].
+void run_components(CircuitData& rData, const ComponentPlan& plan, uint64_t cycles,
+    const NumaPlacement* pPlacement = nullptr);
+
+// Runs one thread per part of a connected circuit, with one barrier per clock. Each cut wire is double-buffered: the
+// driving thread publishes the value into slot (clk + 1) % 2 after its propagate, and every reading thread copies slot
+// clk % 2 into a private shadow wire before its process. Readers are temporarily rewired to their shadows for the
+// duration of the run, so results are the same as a serial run. Threads are pinned as in run_components; pair this with
+// SysNuma::relocate using the same placement so each part's memory is local to its thread.
+void run_partitioned(CircuitData& rData, const Partitioning& partitioning, uint64_t cycles,
+    const NumaPlacement* pPlacement = nullptr);
+}
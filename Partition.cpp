@@ -0,0 +1,443 @@
+#include "Partition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+
+namespace
+{
+
+constexpr uint32_t c_coarsestSize = 64;
+constexpr uint32_t c_fmPasses = 8;
+constexpr uint32_t c_growSeeds = 4;
+
+// Undirected node graph, CSR, with merged parallel edges and no self loops.
+struct WeightedGraph
+{
+    std::vector<uint32_t> m_start;
+    std::vector<uint32_t> m_adj;
+    std::vector<uint32_t> m_edgeWeight;
+    std::vector<uint32_t> m_vertexWeight;
+
+    uint32_t size() const { return uint32_t(m_vertexWeight.size()); }
+};
+
+WeightedGraph from_lists(std::vector<std::vector<std::pair<uint32_t, uint32_t>>>& rLists, std::vector<uint32_t> vertexWeight)
+{
+    WeightedGraph graph;
+    graph.m_vertexWeight = std::move(vertexWeight);
+    graph.m_start.push_back(0);
+    for (uint32_t v = 0; v < rLists.size(); v++)
+    {
+        auto& list = rLists[v];
+        std::sort(list.begin(), list.end());
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            if (list[i].first == v) { continue; }
+            if (!graph.m_adj.empty() && graph.m_adj.size() > graph.m_start.back() && graph.m_adj.back() == list[i].first)
+            {
+                graph.m_edgeWeight.back() += list[i].second;
+                continue;
+            }
+            graph.m_adj.push_back(list[i].first);
+            graph.m_edgeWeight.push_back(list[i].second);
+        }
+        graph.m_start.push_back(uint32_t(graph.m_adj.size()));
+    }
+    return graph;
+}
+
+WeightedGraph coarsen(const WeightedGraph& fine, std::mt19937& rRng, std::vector<uint32_t>& rMap)
+{
+    uint32_t n = fine.size();
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rRng);
+
+    // Heavy-edge matching.
+    std::vector<uint32_t> match(n, noneID_t);
+    for (uint32_t v : order)
+    {
+        if (match[v] != noneID_t) { continue; }
+        uint32_t best = v;
+        uint32_t bestWeight = 0;
+        for (uint32_t e = fine.m_start[v]; e < fine.m_start[v + 1]; e++)
+        {
+            uint32_t u = fine.m_adj[e];
+            if (match[u] == noneID_t && fine.m_edgeWeight[e] > bestWeight)
+            {
+                best = u;
+                bestWeight = fine.m_edgeWeight[e];
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+    }
+
+    rMap.assign(n, noneID_t);
+    uint32_t numCoarse = 0;
+    for (uint32_t v = 0; v < n; v++)
+    {
+        if (rMap[v] != noneID_t) { continue; }
+        rMap[v] = rMap[match[v]] = numCoarse++;
+    }
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> lists(numCoarse);
+    std::vector<uint32_t> vertexWeight(numCoarse, 0);
+    for (uint32_t v = 0; v < n; v++)
+    {
+        uint32_t c = rMap[v];
+        vertexWeight[c] += fine.m_vertexWeight[v];
+        for (uint32_t e = fine.m_start[v]; e < fine.m_start[v + 1]; e++)
+        {
+            lists[c].emplace_back(rMap[fine.m_adj[e]], fine.m_edgeWeight[e]);
+        }
+    }
+    return from_lists(lists, std::move(vertexWeight));
+}
+
+struct Bisection
+{
+    std::vector<uint8_t> m_side;
+    int64_t m_weight[2]{0, 0};
+    int64_t m_maxWeight[2]{0, 0};
+};
+
+int64_t cut_weight(const WeightedGraph& graph, const std::vector<uint8_t>& side)
+{
+    int64_t cut = 0;
+    for (uint32_t v = 0; v < graph.size(); v++)
+    {
+        for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+        {
+            if (side[v] != side[graph.m_adj[e]]) { cut += graph.m_edgeWeight[e]; }
+        }
+    }
+    return cut / 2;
+}
+
+std::vector<int64_t> compute_gains(const WeightedGraph& graph, const std::vector<uint8_t>& side)
+{
+    std::vector<int64_t> gain(graph.size(), 0);
+    for (uint32_t v = 0; v < graph.size(); v++)
+    {
+        for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+        {
+            gain[v] += (side[v] != side[graph.m_adj[e]]) ? int64_t(graph.m_edgeWeight[e]) : -int64_t(graph.m_edgeWeight[e]);
+        }
+    }
+    return gain;
+}
+
+void move_vertex(const WeightedGraph& graph, Bisection& rB, std::vector<int64_t>& rGain, uint32_t v)
+{
+    uint8_t from = rB.m_side[v];
+    uint8_t to = 1 - from;
+    rB.m_side[v] = to;
+    rB.m_weight[from] -= graph.m_vertexWeight[v];
+    rB.m_weight[to] += graph.m_vertexWeight[v];
+    rGain[v] = -rGain[v];
+    for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+    {
+        uint32_t u = graph.m_adj[e];
+        rGain[u] += (rB.m_side[u] == to) ? -2 * int64_t(graph.m_edgeWeight[e]) : 2 * int64_t(graph.m_edgeWeight[e]);
+    }
+}
+
+// Moves the best vertices off an overweight side until both sides fit.
+void rebalance(const WeightedGraph& graph, Bisection& rB)
+{
+    for (uint8_t heavy = 0; heavy < 2; heavy++)
+    {
+        if (rB.m_weight[heavy] <= rB.m_maxWeight[heavy]) { continue; }
+
+        std::vector<int64_t> gain = compute_gains(graph, rB.m_side);
+        std::priority_queue<std::pair<int64_t, uint32_t>> heap;
+        for (uint32_t v = 0; v < graph.size(); v++)
+        {
+            if (rB.m_side[v] == heavy) { heap.emplace(gain[v], v); }
+        }
+        while (rB.m_weight[heavy] > rB.m_maxWeight[heavy] && !heap.empty())
+        {
+            auto [g, v] = heap.top();
+            heap.pop();
+            if (rB.m_side[v] != heavy || g != gain[v]) { continue; }
+            if (rB.m_weight[1 - heavy] + graph.m_vertexWeight[v] > rB.m_maxWeight[1 - heavy]) { continue; }
+
+            move_vertex(graph, rB, gain, v);
+            for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+            {
+                uint32_t u = graph.m_adj[e];
+                if (rB.m_side[u] == heavy) { heap.emplace(gain[u], u); }
+            }
+        }
+    }
+}
+
+// Fiduccia-Mattheyses: each pass moves every vertex at most once, best gain first, then rolls back to the best prefix.
+void refine(const WeightedGraph& graph, Bisection& rB)
+{
+    rebalance(graph, rB);
+
+    uint32_t n = graph.size();
+    std::vector<bool> locked(n);
+    std::vector<uint32_t> moves;
+    for (uint32_t pass = 0; pass < c_fmPasses; pass++)
+    {
+        std::vector<int64_t> gain = compute_gains(graph, rB.m_side);
+        std::priority_queue<std::pair<int64_t, uint32_t>> heap;
+        for (uint32_t v = 0; v < n; v++) { heap.emplace(gain[v], v); }
+        std::fill(locked.begin(), locked.end(), false);
+        moves.clear();
+
+        int64_t total = 0;
+        int64_t best = 0;
+        size_t bestMoves = 0;
+        size_t giveUp = 50 + n / 20;
+        while (!heap.empty() && moves.size() - bestMoves < giveUp)
+        {
+            auto [g, v] = heap.top();
+            heap.pop();
+            if (locked[v] || g != gain[v]) { continue; }
+            uint8_t to = 1 - rB.m_side[v];
+            if (rB.m_weight[to] + graph.m_vertexWeight[v] > rB.m_maxWeight[to]) { continue; }
+
+            move_vertex(graph, rB, gain, v);
+            locked[v] = true;
+            moves.push_back(v);
+            total += g;
+            if (total > best)
+            {
+                best = total;
+                bestMoves = moves.size();
+            }
+            for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+            {
+                uint32_t u = graph.m_adj[e];
+                if (!locked[u]) { heap.emplace(gain[u], u); }
+            }
+        }
+
+        while (moves.size() > bestMoves)
+        {
+            move_vertex(graph, rB, gain, moves.back());
+            moves.pop_back();
+        }
+        if (best <= 0) { break; }
+    }
+}
+
+// Grows side 0 breadth-first from a seed until it holds its share of the weight.
+void grow(const WeightedGraph& graph, Bisection& rB, uint32_t seed, int64_t target0, std::mt19937& rRng)
+{
+    uint32_t n = graph.size();
+    rB.m_side.assign(n, 1);
+    rB.m_weight[0] = 0;
+    rB.m_weight[1] = std::accumulate(graph.m_vertexWeight.begin(), graph.m_vertexWeight.end(), int64_t(0));
+
+    std::vector<bool> queued(n, false);
+    std::queue<uint32_t> frontier;
+    frontier.push(seed);
+    queued[seed] = true;
+    while (rB.m_weight[0] < target0)
+    {
+        if (frontier.empty())
+        {
+            // Disconnected: restart from some vertex not taken yet.
+            uint32_t start = rRng() % n;
+            uint32_t v = start;
+            while (queued[v]) { v = (v + 1) % n; if (v == start) { return; } }
+            frontier.push(v);
+            queued[v] = true;
+        }
+        uint32_t v = frontier.front();
+        frontier.pop();
+        rB.m_side[v] = 0;
+        rB.m_weight[0] += graph.m_vertexWeight[v];
+        rB.m_weight[1] -= graph.m_vertexWeight[v];
+        for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+        {
+            uint32_t u = graph.m_adj[e];
+            if (!queued[u]) { queued[u] = true; frontier.push(u); }
+        }
+    }
+}
+
+std::vector<uint8_t> bisect(const WeightedGraph& graph, double fraction0, double imbalance, std::mt19937& rRng)
+{
+    std::vector<WeightedGraph> levels;
+    std::vector<std::vector<uint32_t>> maps;
+    const WeightedGraph* pCurrent = &graph;
+    while (pCurrent->size() > c_coarsestSize)
+    {
+        std::vector<uint32_t> map;
+        WeightedGraph coarse = coarsen(*pCurrent, rRng, map);
+        if (coarse.size() * 10 > pCurrent->size() * 9) { break; }
+        levels.push_back(std::move(coarse));
+        maps.push_back(std::move(map));
+        pCurrent = &levels.back();
+    }
+
+    int64_t total = std::accumulate(graph.m_vertexWeight.begin(), graph.m_vertexWeight.end(), int64_t(0));
+    int64_t target0 = int64_t(std::llround(double(total) * fraction0));
+    auto limits = [&](const WeightedGraph& level, Bisection& rB)
+    {
+        // Coarse vertices are heavy, so coarse levels get one vertex of slack; the finest level is strict.
+        int64_t slack = (&level == &graph) ? 0 : *std::max_element(level.m_vertexWeight.begin(), level.m_vertexWeight.end());
+        rB.m_maxWeight[0] = int64_t(std::ceil(double(target0) * (1.0 + imbalance))) + slack;
+        rB.m_maxWeight[1] = int64_t(std::ceil(double(total - target0) * (1.0 + imbalance))) + slack;
+    };
+
+    Bisection best;
+    int64_t bestCut = std::numeric_limits<int64_t>::max();
+    for (uint32_t attempt = 0; attempt < c_growSeeds && pCurrent->size() > 0; attempt++)
+    {
+        Bisection candidate;
+        limits(*pCurrent, candidate);
+        grow(*pCurrent, candidate, rRng() % pCurrent->size(), target0, rRng);
+        refine(*pCurrent, candidate);
+        int64_t cut = cut_weight(*pCurrent, candidate.m_side);
+        if (cut < bestCut)
+        {
+            bestCut = cut;
+            best = candidate;
+        }
+    }
+
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        const WeightedGraph& finer = (level == 0) ? graph : levels[level - 1];
+        const std::vector<uint32_t>& map = maps[level];
+        Bisection projected;
+        projected.m_side.resize(finer.size());
+        for (uint32_t v = 0; v < finer.size(); v++)
+        {
+            projected.m_side[v] = best.m_side[map[v]];
+            projected.m_weight[projected.m_side[v]] += finer.m_vertexWeight[v];
+        }
+        limits(finer, projected);
+        refine(finer, projected);
+        best = std::move(projected);
+    }
+    return best.m_side;
+}
+
+WeightedGraph induced(const WeightedGraph& graph, const std::vector<uint32_t>& vertices, std::vector<uint32_t>& rLocal)
+{
+    for (uint32_t i = 0; i < vertices.size(); i++) { rLocal[vertices[i]] = i; }
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> lists(vertices.size());
+    std::vector<uint32_t> vertexWeight(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        uint32_t v = vertices[i];
+        vertexWeight[i] = graph.m_vertexWeight[v];
+        for (uint32_t e = graph.m_start[v]; e < graph.m_start[v + 1]; e++)
+        {
+            uint32_t u = rLocal[graph.m_adj[e]];
+            if (u != noneID_t) { lists[i].emplace_back(u, graph.m_edgeWeight[e]); }
+        }
+    }
+    for (uint32_t v : vertices) { rLocal[v] = noneID_t; }
+    return from_lists(lists, std::move(vertexWeight));
+}
+
+void recurse(const WeightedGraph& graph, const std::vector<uint32_t>& vertices, uint32_t numParts, uint32_t firstPart,
+    double imbalance, std::mt19937& rRng, std::vector<uint32_t>& rScratch, std::vector<uint32_t>& rPart)
+{
+    if (numParts == 1 || vertices.size() <= 1)
+    {
+        for (uint32_t v : vertices) { rPart[v] = firstPart; }
+        return;
+    }
+
+    uint32_t parts0 = numParts / 2;
+    std::vector<uint8_t> side = bisect(graph, double(parts0) / double(numParts), imbalance, rRng);
+
+    std::vector<uint32_t> local[2];
+    for (uint32_t i = 0; i < vertices.size(); i++) { local[side[i]].push_back(i); }
+
+    for (uint8_t s = 0; s < 2; s++)
+    {
+        WeightedGraph sub = induced(graph, local[s], rScratch);
+        std::vector<uint32_t> subVertices(local[s].size());
+        for (size_t i = 0; i < local[s].size(); i++) { subVertices[i] = vertices[local[s][i]]; }
+        recurse(sub, subVertices, s == 0 ? parts0 : numParts - parts0, s == 0 ? firstPart : firstPart + parts0,
+            imbalance, rRng, rScratch, rPart);
+    }
+}
+
+} // namespace
+
+Partitioning SysPartition::partition(CircuitData& rData, const NetlistGraph& graph, uint32_t numParts, float imbalance,
+    uint32_t seed)
+{
+    Partitioning result;
+    result.m_numParts = std::max(numParts, 1u);
+    result.m_part.assign(graph.num_nodes(), noneID_t);
+
+    std::vector<uint32_t> vertexOf(graph.num_nodes(), noneID_t);
+    std::vector<uint32_t> vertices;
+    for (nodeID_t id = 0; id < graph.num_nodes(); id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        vertexOf[id] = uint32_t(vertices.size());
+        vertices.push_back(id);
+    }
+
+    // A wire is a star from its driver to each reader.
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> lists(vertices.size());
+    for (edgeID_t wire = 0; wire < graph.num_wires(); wire++)
+    {
+        nodeID_t driver = graph.m_driver[wire];
+        if (driver == nullNode_t || vertexOf[driver] == noneID_t) { continue; }
+        for (uint32_t r = graph.m_readerStart[wire]; r < graph.m_readerStart[wire + 1]; r++)
+        {
+            uint32_t a = vertexOf[driver];
+            uint32_t b = vertexOf[graph.m_readers[r]];
+            lists[a].emplace_back(b, 1);
+            lists[b].emplace_back(a, 1);
+        }
+    }
+    WeightedGraph weighted = from_lists(lists, std::vector<uint32_t>(vertices.size(), 1));
+
+    // Each level of the recursion gets its share of the allowed imbalance.
+    double depth = std::max(1.0, std::ceil(std::log2(double(result.m_numParts))));
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> scratch(vertices.size(), noneID_t);
+    std::vector<uint32_t> vertexPart(vertices.size(), 0);
+    std::vector<uint32_t> all(vertices.size());
+    std::iota(all.begin(), all.end(), 0);
+    recurse(weighted, all, result.m_numParts, 0, double(imbalance) / depth, rng, scratch, vertexPart);
+
+    for (uint32_t v = 0; v < vertices.size(); v++) { result.m_part[vertices[v]] = vertexPart[v]; }
+    update_cut(graph, result);
+    return result;
+}
+
+void SysPartition::update_cut(const NetlistGraph& graph, Partitioning& rPartitioning)
+{
+    rPartitioning.m_cutWires.clear();
+    rPartitioning.m_partSize.assign(rPartitioning.m_numParts, 0);
+    for (uint32_t part : rPartitioning.m_part)
+    {
+        if (part != noneID_t) { rPartitioning.m_partSize[part]++; }
+    }
+
+    for (edgeID_t wire = 0; wire < graph.num_wires(); wire++)
+    {
+        nodeID_t driver = graph.m_driver[wire];
+        if (driver == nullNode_t) { continue; }
+        for (uint32_t r = graph.m_readerStart[wire]; r < graph.m_readerStart[wire + 1]; r++)
+        {
+            if (rPartitioning.m_part[graph.m_readers[r]] != rPartitioning.m_part[driver])
+            {
+                rPartitioning.m_cutWires.push_back(wire);
+                break;
+            }
+        }
+    }
+}
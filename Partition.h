@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Netlist.h"
+
+// GRAPH PARTITIONING
+
+/**
+ * Split of the circuit's nodes into m_numParts balanced parts. m_cutWires are the wires read by at least one node
+ * outside the part that drives them; those are the only values threads have to exchange.
+ */
+struct Partitioning
+{
+    std::vector<uint32_t> m_part;       // per node, noneID_t for empty slots
+    uint32_t m_numParts{0};
+    std::vector<edgeID_t> m_cutWires;
+    std::vector<size_t> m_partSize;
+};
+
+namespace SysPartition
+{
+/**
+ * Multilevel k-way partitioner by recursive bisection. Each bisection coarsens the node graph by heavy-edge matching,
+ * bisects the coarsest graph by greedy region growing, then projects back level by level with Fiduccia-Mattheyses
+ * refinement. Parts stay within imbalance of their share of the nodes.
+ */
+Partitioning partition(CircuitData& rData, const NetlistGraph& graph, uint32_t numParts, float imbalance = 0.03f,
+    uint32_t seed = 1);
+
+// Recomputes m_cutWires and m_partSize from m_part.
+void update_cut(const NetlistGraph& graph, Partitioning& rPartitioning);
+}
@@ -0,0 +1,135 @@
+#include "Profile.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "DeltaCycle.h"
+
+namespace
+{
+
+constexpr uint64_t c_never = UINT64_MAX;
+constexpr const char* c_header = "node-order 1";
+
+constexpr uint64_t c_fnvOffset = 14695981039346656037ull;
+constexpr uint64_t c_fnvPrime = 1099511628211ull;
+
+void hash(uint64_t& rHash, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        rHash ^= (value >> (i * 8)) & 0xff;
+        rHash *= c_fnvPrime;
+    }
+}
+
+uint32_t bucket(uint64_t count)
+{
+    uint32_t b = 0;
+    while (count > 1)
+    {
+        count >>= 1;
+        b++;
+    }
+    return b;
+}
+
+} // namespace
+
+uint64_t SysProfile::fingerprint(CircuitData& rData)
+{
+    uint64_t result = c_fnvOffset;
+    hash(result, rData.m_nodes.size());
+    hash(result, rData.m_edges.size());
+    for (auto& pNode : rData.m_nodes)
+    {
+        hash(result, pNode ? 1 : 0);
+        if (!pNode) { continue; }
+        pNode->terminals([&result](edgeID_t& rWire, bool isOutput) { hash(result, (uint64_t(rWire) << 1) | isOutput); });
+    }
+    return result;
+}
+
+AccessProfile SysProfile::record(CircuitData& rData, uint64_t cycles, const std::function<void(uint64_t clk)>& stimulus)
+{
+    AccessProfile profile;
+    profile.m_fingerprint = SysProfile::fingerprint(rData);
+    profile.m_cycles = cycles;
+    profile.m_evaluations.assign(rData.m_nodes.size(), 0);
+    profile.m_firstSeen.assign(rData.m_nodes.size(), c_never);
+
+    DeltaState state = SysDelta::prepare(rData);
+    std::vector<nodeID_t> trace;
+    state.m_pTrace = &trace;
+
+    uint64_t position = 0;
+    for (uint64_t clk = 0; clk < cycles; clk++)
+    {
+        if (stimulus) { stimulus(clk); }
+        SysDelta::step(rData, state);
+        for (nodeID_t id : trace)
+        {
+            profile.m_evaluations[id]++;
+            if (profile.m_firstSeen[id] == c_never) { profile.m_firstSeen[id] = position; }
+            position++;
+        }
+        trace.clear();
+    }
+    return profile;
+}
+
+std::vector<nodeID_t> SysProfile::order(const AccessProfile& profile)
+{
+    std::vector<nodeID_t> result;
+    for (nodeID_t id = 1; id < profile.m_evaluations.size(); id++)
+    {
+        if (profile.m_evaluations[id] > 0) { result.push_back(id); }
+    }
+    std::sort(result.begin(), result.end(), [&profile](nodeID_t a, nodeID_t b)
+    {
+        uint32_t bucketA = bucket(profile.m_evaluations[a]);
+        uint32_t bucketB = bucket(profile.m_evaluations[b]);
+        if (bucketA != bucketB) { return bucketA > bucketB; }
+        return profile.m_firstSeen[a] < profile.m_firstSeen[b];
+    });
+    return result;
+}
+
+bool SysProfile::save(const AccessProfile& profile, const std::string& path)
+{
+    std::ofstream out(path);
+    out << c_header << "\n";
+    out << "fingerprint " << profile.m_fingerprint << "\n";
+    for (nodeID_t id : SysProfile::order(profile)) { out << id << "\n"; }
+    if (!out)
+    {
+        std::cerr << "SysProfile: can't write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool SysProfile::apply(CircuitData& rData, const std::string& path, Renumbering* pRenumbering)
+{
+    std::ifstream in(path);
+    std::string header, keyword;
+    uint64_t fingerprint = 0;
+    if (!std::getline(in, header) || header != c_header || !(in >> keyword >> fingerprint) || keyword != "fingerprint")
+    {
+        std::cerr << "SysProfile: " << path << " isn't a node order file\n";
+        return false;
+    }
+    if (fingerprint != SysProfile::fingerprint(rData))
+    {
+        std::cerr << "SysProfile: " << path << " was recorded on a different netlist\n";
+        return false;
+    }
+
+    std::vector<nodeID_t> nodeOrder;
+    nodeID_t id;
+    while (in >> id) { nodeOrder.push_back(id); }
+
+    Renumbering renumbering = SysReorder::apply(rData, nodeOrder);
+    if (pRenumbering) { *pRenumbering = std::move(renumbering); }
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Reorder.h"
+
+// PROFILE-GUIDED ORDERING
+
+/**
+ * What a training run actually evaluated. Under SysDelta a combinational node only runs when an input changed, so
+ * m_evaluations separates the logic the stimulus exercises from the logic it doesn't, and m_firstSeen records the
+ * order things first fired in.
+ */
+struct AccessProfile
+{
+    std::vector<uint64_t> m_evaluations;    // per node
+    std::vector<uint64_t> m_firstSeen;      // per node, index into the trace of its first evaluation; UINT64_MAX if never
+    uint64_t m_cycles{0};
+    uint64_t m_fingerprint{0};              // of the netlist the profile was taken on
+};
+
+namespace SysProfile
+{
+// Hash of the node and wire count and every node's terminal list. Stable across runs that build the same netlist in
+// the same order, whatever the wire values.
+uint64_t fingerprint(CircuitData& rData);
+
+/**
+ * Training run: cycles clocks of SysDelta::step, calling stimulus(clk) before each to drive inputs. Simulates rData,
+ * so use a copy built for the purpose if its state matters.
+ */
+AccessProfile record(CircuitData& rData, uint64_t cycles, const std::function<void(uint64_t clk)>& stimulus = {});
+
+/**
+ * Node order for SysReorder::apply: hottest first, in power-of-two buckets of evaluation count, and in firing order
+ * within a bucket, so logic that switches together sits together. Nodes that never ran go last, in ID order.
+ */
+std::vector<nodeID_t> order(const AccessProfile& profile);
+
+/**
+ * Writes the profile's order to a text file: a header with the fingerprint, then one node ID per line. Wires aren't
+ * listed; SysReorder::apply numbers them from the node order, so the same order gives the same wire layout.
+ */
+bool save(const AccessProfile& profile, const std::string& path);
+
+/**
+ * Renumbers a freshly built circuit with an order saved by save(). Returns false, leaving rData alone, if the file
+ * can't be read or was recorded on a different netlist.
+ */
+bool apply(CircuitData& rData, const std::string& path, Renumbering* pRenumbering = nullptr);
+}
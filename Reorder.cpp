@@ -0,0 +1,283 @@
+#include "Reorder.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "Schedule.h"
+
+namespace
+{
+
+// Undirected node adjacency (wire shared with a driver or a reader), deduplicated, in CSR form.
+void undirected(CircuitData& rData, const NetlistGraph& graph, std::vector<uint32_t>& rStart,
+    std::vector<nodeID_t>& rAdjacent)
+{
+    size_t numNodes = graph.num_nodes();
+    std::vector<std::vector<nodeID_t>> lists(numNodes);
+    std::vector<nodeID_t> successors;
+    for (nodeID_t id = 1; id < numNodes; id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        successors.clear();
+        SysNetlist::successors(graph, id, successors);
+        for (nodeID_t next : successors)
+        {
+            if (next == id) { continue; }
+            lists[id].push_back(next);
+            lists[next].push_back(id);
+        }
+    }
+
+    rStart.assign(numNodes + 1, 0);
+    rAdjacent.clear();
+    for (nodeID_t id = 0; id < numNodes; id++)
+    {
+        std::sort(lists[id].begin(), lists[id].end());
+        lists[id].erase(std::unique(lists[id].begin(), lists[id].end()), lists[id].end());
+        rAdjacent.insert(rAdjacent.end(), lists[id].begin(), lists[id].end());
+        rStart[id + 1] = uint32_t(rAdjacent.size());
+    }
+}
+
+// Breadth-first from root, neighbours by increasing degree. Appends to rOut; returns where in rOut the last level starts
+// and sets rLevels to the number of levels.
+size_t cuthill_mckee(const std::vector<uint32_t>& start, const std::vector<nodeID_t>& adjacent, nodeID_t root,
+    std::vector<uint8_t>& rVisited, std::vector<nodeID_t>& rOut, uint32_t& rLevels)
+{
+    auto degree = [&start](nodeID_t v) { return start[v + 1] - start[v]; };
+
+    size_t head = rOut.size();
+    size_t lastLevel = head;
+    size_t levelEnd = head + 1;
+    rOut.push_back(root);
+    rVisited[root] = 1;
+
+    rLevels = 1;
+    std::vector<nodeID_t> next;
+    while (head < rOut.size())
+    {
+        if (head == levelEnd)
+        {
+            lastLevel = head;
+            levelEnd = rOut.size();
+            rLevels++;
+        }
+        nodeID_t v = rOut[head++];
+        next.clear();
+        for (uint32_t i = start[v]; i < start[v + 1]; i++)
+        {
+            if (!rVisited[adjacent[i]]) { next.push_back(adjacent[i]); }
+        }
+        std::sort(next.begin(), next.end(), [&](nodeID_t a, nodeID_t b)
+        {
+            return degree(a) != degree(b) ? degree(a) < degree(b) : a < b;
+        });
+        for (nodeID_t u : next)
+        {
+            rVisited[u] = 1;
+            rOut.push_back(u);
+        }
+    }
+    return lastLevel;
+}
+
+std::vector<nodeID_t> reverse_cuthill_mckee(CircuitData& rData, const NetlistGraph& graph)
+{
+    std::vector<uint32_t> start;
+    std::vector<nodeID_t> adjacent;
+    undirected(rData, graph, start, adjacent);
+    auto degree = [&start](nodeID_t v) { return start[v + 1] - start[v]; };
+
+    std::vector<nodeID_t> byDegree;
+    for (nodeID_t id = 1; id < graph.num_nodes(); id++)
+    {
+        if (rData.m_nodes[id]) { byDegree.push_back(id); }
+    }
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&](nodeID_t a, nodeID_t b) { return degree(a) < degree(b); });
+
+    std::vector<uint8_t> visited(graph.num_nodes(), 0);
+    std::vector<nodeID_t> order, probe;
+    for (nodeID_t seed : byDegree)
+    {
+        if (visited[seed]) { continue; }
+
+        // Pseudo-peripheral root: keep jumping to a minimum-degree node of the last BFS level while that makes the
+        // BFS deeper.
+        nodeID_t root = seed;
+        uint32_t depth = 0;
+        for (;;)
+        {
+            // The probe marks the nodes it reaches in visited; it reaches exactly the ones it lists, so unmarking those
+            // afterwards restores visited without copying it.
+            probe.clear();
+            uint32_t levels = 0;
+            size_t lastLevel = cuthill_mckee(start, adjacent, root, visited, probe, levels);
+            for (nodeID_t v : probe) { visited[v] = 0; }
+            nodeID_t candidate = *std::min_element(probe.begin() + lastLevel, probe.end(), [&](nodeID_t a, nodeID_t b)
+            {
+                return degree(a) < degree(b);
+            });
+            if (levels <= depth || candidate == root) { break; }
+            depth = levels;
+            root = candidate;
+        }
+        uint32_t levels = 0;
+        cuthill_mckee(start, adjacent, root, visited, order, levels);
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::vector<nodeID_t> fanout_dfs(CircuitData& rData, const NetlistGraph& graph)
+{
+    size_t numNodes = graph.num_nodes();
+    std::vector<nodeID_t> roots, rest;
+    for (nodeID_t id = 1; id < numNodes; id++)
+    {
+        if (!rData.m_nodes[id]) { continue; }
+        bool driven = false;
+        for (uint32_t i = graph.m_inputStart[id]; i < graph.m_inputStart[id + 1]; i++)
+        {
+            driven |= graph.m_driver[graph.m_inputs[i]] != nullNode_t;
+        }
+        (driven ? rest : roots).push_back(id);
+    }
+    roots.insert(roots.end(), rest.begin(), rest.end());
+
+    // Reverse postorder: topological on the acyclic parts, and a node's fanout chain follows it directly.
+    struct Frame
+    {
+        nodeID_t m_node;
+        std::vector<nodeID_t> m_successors;
+        size_t m_next;
+    };
+    std::vector<uint8_t> visited(numNodes, 0);
+    std::vector<nodeID_t> order;
+    std::vector<Frame> stack;
+    auto enter = [&](nodeID_t v)
+    {
+        visited[v] = 1;
+        stack.push_back(Frame{v, {}, 0});
+        SysNetlist::successors(graph, v, stack.back().m_successors);
+    };
+
+    for (nodeID_t root : roots)
+    {
+        if (visited[root]) { continue; }
+        enter(root);
+        while (!stack.empty())
+        {
+            Frame& rTop = stack.back();
+            if (rTop.m_next == rTop.m_successors.size())
+            {
+                order.push_back(rTop.m_node);
+                stack.pop_back();
+                continue;
+            }
+            nodeID_t v = rTop.m_successors[rTop.m_next++];
+            if (!visited[v] && rData.m_nodes[v]) { enter(v); }
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+} // namespace
+
+std::vector<nodeID_t> SysReorder::order(CircuitData& rData, const NetlistGraph& graph, NodeOrder how)
+{
+    switch (how)
+    {
+    case NodeOrder::ReverseCuthillMcKee:
+        return reverse_cuthill_mckee(rData, graph);
+    case NodeOrder::FanoutDfs:
+        return fanout_dfs(rData, graph);
+    case NodeOrder::Level:
+    {
+        Schedule schedule = SysSchedule::build(rData);
+        std::vector<nodeID_t> order = schedule.m_clocked;
+        order.insert(order.end(), schedule.m_order.begin(), schedule.m_order.end());
+        return order;
+    }
+    }
+    return {};
+}
+
+Renumbering SysReorder::apply(CircuitData& rData, const std::vector<nodeID_t>& nodeOrder)
+{
+    size_t numNodes = rData.m_nodes.size();
+    size_t numWires = rData.m_edges.size();
+
+    Renumbering result;
+    result.m_newNode.assign(numNodes, noneID_t);
+    result.m_newWire.assign(numWires, noneID_t);
+    result.m_newNode[nullNode_t] = nullNode_t;
+    result.m_newWire[nullEdge_t] = nullEdge_t;
+
+    std::vector<nodeID_t> oldNode{nullNode_t};
+    auto take = [&](nodeID_t id)
+    {
+        if (id < numNodes && result.m_newNode[id] == noneID_t && rData.m_nodes[id])
+        {
+            result.m_newNode[id] = nodeID_t(oldNode.size());
+            oldNode.push_back(id);
+        }
+    };
+    for (nodeID_t id : nodeOrder) { take(id); }
+    for (nodeID_t id = 1; id < numNodes; id++) { take(id); }
+    for (nodeID_t id = 1; id < numNodes; id++)
+    {
+        if (result.m_newNode[id] == noneID_t)
+        {
+            result.m_newNode[id] = nodeID_t(oldNode.size());
+            oldNode.push_back(id);
+        }
+    }
+
+    // Wires by first touch, rewriting terminals on the way.
+    std::vector<edgeID_t> oldWire{nullEdge_t};
+    for (size_t n = 1; n < oldNode.size(); n++)
+    {
+        if (!rData.m_nodes[oldNode[n]]) { continue; }
+        rData.m_nodes[oldNode[n]]->terminals([&](edgeID_t& rWire, bool)
+        {
+            if (rWire >= numWires) { return; }
+            if (result.m_newWire[rWire] == noneID_t)
+            {
+                result.m_newWire[rWire] = edgeID_t(oldWire.size());
+                oldWire.push_back(rWire);
+            }
+            rWire = result.m_newWire[rWire];
+        });
+    }
+    for (edgeID_t wire = 1; wire < numWires; wire++)
+    {
+        if (result.m_newWire[wire] == noneID_t)
+        {
+            result.m_newWire[wire] = edgeID_t(oldWire.size());
+            oldWire.push_back(wire);
+        }
+    }
+
+    std::vector<std::shared_ptr<Node>> nodes(numNodes);
+    for (size_t n = 0; n < numNodes; n++) { nodes[n] = std::move(rData.m_nodes[oldNode[n]]); }
+    for (size_t n = 0; n < numNodes; n++) { rData.m_nodes[n] = std::move(nodes[n]); }
+
+    std::vector<std::shared_ptr<Connection>> edges(numWires);
+    for (size_t w = 0; w < numWires; w++) { edges[w] = std::move(rData.m_edges[oldWire[w]]); }
+    for (size_t w = 0; w < numWires; w++) { rData.m_edges[w] = std::move(edges[w]); }
+
+    for (auto& pWire : rData.m_edges)
+    {
+        if (!pWire) { continue; }
+        if (pWire->m_in < numNodes) { pWire->m_in = result.m_newNode[pWire->m_in]; }
+        if (pWire->m_out < numNodes) { pWire->m_out = result.m_newNode[pWire->m_out]; }
+    }
+    return result;
+}
+
+Renumbering SysReorder::reorder(CircuitData& rData, NodeOrder how)
+{
+    NetlistGraph graph = SysNetlist::build(rData);
+    return SysReorder::apply(rData, SysReorder::order(rData, graph, how));
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Netlist.h"
+
+// LOCALITY REORDERING
+
+enum class NodeOrder
+{
+    ReverseCuthillMcKee,    // bandwidth-reducing BFS over the undirected node graph, reversed
+    FanoutDfs,              // reverse postorder of a depth-first walk along fanout from the sources
+    Level                   // SysSchedule order: clocked nodes, then combinational nodes level by level
+};
+
+// Old ID to new ID, for callers holding on to IDs across a renumbering.
+struct Renumbering
+{
+    std::vector<nodeID_t> m_newNode;
+    std::vector<edgeID_t> m_newWire;
+};
+
+namespace SysReorder
+{
+// The circuit's non-empty nodes in the given order, as old IDs.
+std::vector<nodeID_t> order(CircuitData& rData, const NetlistGraph& graph, NodeOrder how);
+
+/**
+ * Renumbers nodes so that nodeOrder comes first (nodes it leaves out follow in ID order, empty slots go last), and
+ * wires in the order the renumbered nodes first touch them, so consecutive nodes use consecutive wires. Rewrites every
+ * terminal through Node::terminals() and every Connection's m_in/m_out; NodeTerminal::m_parentID isn't visible to
+ * the pass and is left alone. Schedules, partitionings and graphs built before this are stale. process_all visits
+ * nodes in the new order, which only shows for nodes with side effects, such as Printer.
+ */
+Renumbering apply(CircuitData& rData, const std::vector<nodeID_t>& nodeOrder);
+
+Renumbering reorder(CircuitData& rData, NodeOrder how);
+}
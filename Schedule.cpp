@@ -0,0 +1,301 @@
+#include "Schedule.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+
+bool is_combinational(CircuitData& rData, nodeID_t id)
+{
+    return rData.m_nodes[id] && rData.m_nodes[id]->combinational();
+}
+
+void prefetch(const void* p, bool forWrite)
+{
+#if defined(__GNUC__)
+    if (forWrite) { __builtin_prefetch(p, 1); }
+    else { __builtin_prefetch(p, 0); }
+#else
+    (void)p;
+    (void)forWrite;
+#endif
+}
+
+// The node object and the wires it reads, ahead of process().
+void prefetch_process(CircuitData& rData, const NetlistGraph& graph, nodeID_t id)
+{
+    prefetch(rData.m_nodes[id].get(), false);
+    for (uint32_t i = graph.m_inputStart[id]; i < graph.m_inputStart[id + 1]; i++)
+    {
+        prefetch(rData.m_edges[graph.m_inputs[i]].get(), false);
+    }
+}
+
+// The wires it writes, ahead of propagate().
+void prefetch_propagate(CircuitData& rData, const NetlistGraph& graph, nodeID_t id)
+{
+    for (uint32_t i = graph.m_outputStart[id]; i < graph.m_outputStart[id + 1]; i++)
+    {
+        prefetch(rData.m_edges[graph.m_outputs[i]].get(), true);
+    }
+}
+
+// Runs process then propagate over [pFirst, pLast). With a distance, also prefetches for the node that many places
+// further on, up to pEnd, which may lie past pLast in a later step.
+void run_range(CircuitData& rData, const NetlistGraph& graph, const nodeID_t* pFirst, const nodeID_t* pLast,
+    const nodeID_t* pEnd, uint32_t distance)
+{
+    if (distance == 0)
+    {
+        for (const nodeID_t* p = pFirst; p != pLast; p++) { rData.m_nodes[*p]->process(rData); }
+        for (const nodeID_t* p = pFirst; p != pLast; p++) { rData.m_nodes[*p]->propagate(rData); }
+        return;
+    }
+
+    const nodeID_t* pAhead = pFirst + std::min<size_t>(distance, pEnd - pFirst);
+    for (const nodeID_t* p = pFirst; p != pLast; p++)
+    {
+        if (pAhead != pEnd) { prefetch_process(rData, graph, *pAhead++); }
+        rData.m_nodes[*p]->process(rData);
+    }
+    pAhead = pFirst + std::min<size_t>(distance, pLast - pFirst);
+    for (const nodeID_t* p = pFirst; p != pLast; p++)
+    {
+        if (pAhead != pLast) { prefetch_propagate(rData, graph, *pAhead++); }
+        rData.m_nodes[*p]->propagate(rData);
+    }
+}
+
+} // namespace
+
+uint32_t SysSchedule::find_sccs(CircuitData& rData, const NetlistGraph& graph, std::vector<uint32_t>& rComponent)
+{
+    size_t numNodes = graph.num_nodes();
+    rComponent.assign(numNodes, noneID_t);
+
+    std::vector<uint32_t> index(numNodes, noneID_t);
+    std::vector<uint32_t> lowLink(numNodes, 0);
+    std::vector<bool> onStack(numNodes, false);
+    std::vector<nodeID_t> sccStack;
+
+    // Explicit DFS stack of (node, position in its successor list).
+    std::vector<std::pair<nodeID_t, uint32_t>> callStack;
+    std::vector<std::vector<nodeID_t>> successors(numNodes);
+
+    uint32_t nextIndex = 0;
+    uint32_t numComponents = 0;
+
+    for (nodeID_t root = 0; root < numNodes; root++)
+    {
+        if (index[root] != noneID_t || !is_combinational(rData, root)) { continue; }
+
+        callStack.emplace_back(root, 0);
+        while (!callStack.empty())
+        {
+            nodeID_t node = callStack.back().first;
+            uint32_t& rNext = callStack.back().second;
+
+            if (rNext == 0 && index[node] == noneID_t)
+            {
+                index[node] = lowLink[node] = nextIndex++;
+                sccStack.push_back(node);
+                onStack[node] = true;
+                SysNetlist::successors(graph, node, successors[node]);
+            }
+
+            bool descended = false;
+            while (rNext < successors[node].size())
+            {
+                nodeID_t succ = successors[node][rNext++];
+                if (!is_combinational(rData, succ)) { continue; }
+                if (index[succ] == noneID_t)
+                {
+                    callStack.emplace_back(succ, 0);
+                    descended = true;
+                    break;
+                }
+                if (onStack[succ]) { lowLink[node] = std::min(lowLink[node], index[succ]); }
+            }
+            if (descended) { continue; }
+
+            if (lowLink[node] == index[node])
+            {
+                nodeID_t member;
+                do
+                {
+                    member = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[member] = false;
+                    rComponent[member] = numComponents;
+                } while (member != node);
+                numComponents++;
+            }
+
+            successors[node].clear();
+            successors[node].shrink_to_fit();
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                nodeID_t parent = callStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+        }
+    }
+    return numComponents;
+}
+
+Schedule SysSchedule::build(CircuitData& rData, uint32_t maxIterations)
+{
+    Schedule schedule;
+    schedule.m_graph = SysNetlist::build(rData);
+    schedule.m_maxIterations = maxIterations;
+    const NetlistGraph& graph = schedule.m_graph;
+
+    std::vector<uint32_t> component;
+    uint32_t numComponents = find_sccs(rData, graph, component);
+
+    size_t numNodes = graph.num_nodes();
+    std::vector<std::vector<nodeID_t>> members(numComponents);
+    for (nodeID_t id = 0; id < numNodes; id++)
+    {
+        if (component[id] != noneID_t) { members[component[id]].push_back(id); }
+        else if (rData.m_nodes[id]) { schedule.m_clocked.push_back(id); }
+    }
+
+    // Tarjan numbers components in reverse topological order, so walking them from the highest number down visits
+    // every component after all of its predecessors.
+    std::vector<uint32_t> level(numComponents, 0);
+    std::vector<bool> cyclic(numComponents, false);
+    std::vector<nodeID_t> succ;
+    for (uint32_t c = numComponents; c-- > 0;)
+    {
+        cyclic[c] = members[c].size() > 1;
+        for (nodeID_t node : members[c])
+        {
+            succ.clear();
+            SysNetlist::successors(graph, node, succ);
+            for (nodeID_t s : succ)
+            {
+                uint32_t sc = component[s];
+                if (sc == noneID_t) { continue; }
+                if (sc == c) { cyclic[c] = true; }
+                else { level[sc] = std::max(level[sc], level[c] + 1); }
+            }
+        }
+        schedule.m_numLevels = std::max(schedule.m_numLevels, level[c] + 1);
+    }
+
+    std::vector<uint32_t> byLevel(numComponents);
+    for (uint32_t c = 0; c < numComponents; c++) { byLevel[c] = c; }
+    std::stable_sort(byLevel.begin(), byLevel.end(), [&](uint32_t a, uint32_t b)
+    {
+        if (level[a] != level[b]) { return level[a] < level[b]; }
+        return cyclic[a] < cyclic[b];
+    });
+
+    for (uint32_t c : byLevel)
+    {
+        std::vector<ScheduleStep>& rSteps = schedule.m_steps;
+        bool extend = !rSteps.empty() && !cyclic[c] && !rSteps.back().m_cyclic && rSteps.back().m_level == level[c];
+        if (!extend)
+        {
+            rSteps.push_back(ScheduleStep{uint32_t(schedule.m_order.size()), 0, level[c], cyclic[c]});
+        }
+
+        std::sort(members[c].begin(), members[c].end());
+        schedule.m_order.insert(schedule.m_order.end(), members[c].begin(), members[c].end());
+        rSteps.back().m_count += uint32_t(members[c].size());
+    }
+
+    std::vector<edgeID_t> loopWires;
+    for (const ScheduleStep& step : schedule.m_steps)
+    {
+        if (!step.m_cyclic) { continue; }
+        for (uint32_t i = step.m_first; i < step.m_first + step.m_count; i++)
+        {
+            nodeID_t node = schedule.m_order[i];
+            loopWires.insert(loopWires.end(), graph.m_outputs.begin() + graph.m_outputStart[node],
+                graph.m_outputs.begin() + graph.m_outputStart[node + 1]);
+        }
+    }
+    schedule.m_loopWires = SysNetlist::snapshot(rData, loopWires);
+    return schedule;
+}
+
+bool SysSchedule::step(CircuitData& rData, Schedule& rSchedule)
+{
+    rSchedule.m_loopIterations = 0;
+    rSchedule.m_converged = true;
+
+    const NetlistGraph& graph = rSchedule.m_graph;
+    uint32_t maxIterations = std::max(rSchedule.m_maxIterations, 1u);
+    const nodeID_t* pClocked = rSchedule.m_clocked.data();
+    size_t numClocked = rSchedule.m_clocked.size();
+    run_range(rData, graph, pClocked, pClocked + numClocked, pClocked + numClocked, rSchedule.m_prefetchDistance);
+
+    const nodeID_t* pEnd = rSchedule.m_order.data() + rSchedule.m_order.size();
+    for (const ScheduleStep& step : rSchedule.m_steps)
+    {
+        const nodeID_t* pFirst = rSchedule.m_order.data() + step.m_first;
+        const nodeID_t* pLast = pFirst + step.m_count;
+
+        if (!step.m_cyclic)
+        {
+            run_range(rData, graph, pFirst, pLast, pEnd, rSchedule.m_prefetchDistance);
+            continue;
+        }
+
+        for (uint32_t iteration = 0;; iteration++)
+        {
+            if (iteration == maxIterations)
+            {
+                rSchedule.m_converged = false;
+                break;
+            }
+            rSchedule.m_loopIterations++;
+
+            for (const nodeID_t* p = pFirst; p != pLast; p++) { rData.m_nodes[*p]->process(rData); }
+            for (const nodeID_t* p = pFirst; p != pLast; p++) { rData.m_nodes[*p]->propagate(rData); }
+
+            bool changed = false;
+            for (const nodeID_t* p = pFirst; p != pLast; p++)
+            {
+                for (uint32_t i = graph.m_outputStart[*p]; i < graph.m_outputStart[*p + 1]; i++)
+                {
+                    changed |= SysNetlist::latch(rData, rSchedule.m_loopWires, graph.m_outputs[i]);
+                }
+            }
+            if (!changed) { break; }
+        }
+    }
+    return rSchedule.m_converged;
+}
+
+uint32_t SysSchedule::tune_prefetch(CircuitData& rData, Schedule& rSchedule, uint32_t cyclesPerTrial)
+{
+    using clock = std::chrono::steady_clock;
+    constexpr uint32_t c_candidates[] = {0, 1, 2, 4, 8, 16, 32, 64};
+    constexpr int c_trials = 3;
+
+    uint32_t best = 0;
+    clock::duration bestTime = clock::duration::max();
+    for (uint32_t distance : c_candidates)
+    {
+        rSchedule.m_prefetchDistance = distance;
+        clock::duration fastest = clock::duration::max();
+        for (int trial = 0; trial < c_trials; trial++)
+        {
+            clock::time_point start = clock::now();
+            for (uint32_t cycle = 0; cycle < cyclesPerTrial; cycle++) { SysSchedule::step(rData, rSchedule); }
+            fastest = std::min(fastest, clock::now() - start);
+        }
+        if (fastest < bestTime)
+        {
+            bestTime = fastest;
+            best = distance;
+        }
+    }
+    rSchedule.m_prefetchDistance = best;
+    return best;
+}
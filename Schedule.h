@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Netlist.h"
+
+// LEVELIZED SCHEDULE
+
+/**
+ * A run of m_order. Acyclic steps hold the nodes of one topological level, which don't depend on each other and are
+ * evaluated once. Cyclic steps hold one strongly connected component (a combinational feedback loop) and are iterated
+ * until none of their output wires change.
+ */
+struct ScheduleStep
+{
+    uint32_t m_first{0};
+    uint32_t m_count{0};
+    uint32_t m_level{0};
+    bool m_cyclic{false};
+};
+
+/**
+ * Compiled evaluation order for one clock. Clocked nodes run first, once, like process_all + propagate_all; the
+ * combinational nodes are then evaluated level by level, so every node sees its inputs' settled values. Only the
+ * feedback loops pay for fixed-point iteration. Build with SysSchedule::build and rebuild after editing the circuit,
+ * or use a LiveSchedule (LiveSchedule.h) where edits are frequent.
+ */
+struct Schedule
+{
+    NetlistGraph m_graph;
+    std::vector<nodeID_t> m_clocked;
+    std::vector<nodeID_t> m_order;
+    std::vector<ScheduleStep> m_steps;
+    uint32_t m_numLevels{0};
+
+    uint32_t m_maxIterations{1000};                 // per loop per clock; 0 counts as 1
+    WireSnapshot m_loopWires;                       // outputs of the loops, to see when they settle
+
+    // How many nodes ahead step() prefetches each node's object and input wires (before process) and output wires
+    // (before propagate). 0 turns prefetching off; SysSchedule::tune_prefetch picks a value for the host.
+    uint32_t m_prefetchDistance{0};
+
+    // Stats for the last step()
+    uint32_t m_loopIterations{0};
+    bool m_converged{true};
+};
+
+namespace SysSchedule
+{
+Schedule build(CircuitData& rData, uint32_t maxIterations = 1000);
+
+// Strongly connected components of the combinational subgraph (Tarjan's algorithm, iterative). Components come out in
+// reverse topological order; rComponent maps each node to its component, or noneID_t for non-combinational nodes.
+uint32_t find_sccs(CircuitData& rData, const NetlistGraph& graph, std::vector<uint32_t>& rComponent);
+
+// One clock. Returns false if a feedback loop didn't settle within the iteration limit.
+bool step(CircuitData& rData, Schedule& rSchedule);
+
+// Times cyclesPerTrial clocks at each of a range of prefetch distances, best of three, and keeps the fastest in
+// rSchedule.m_prefetchDistance. Returns it. This simulates rData, so run it as warm-up or on a copy.
+uint32_t tune_prefetch(CircuitData& rData, Schedule& rSchedule, uint32_t cyclesPerTrial = 64);
+}
@@ -0,0 +1,422 @@
+#include "Shard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <new>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "CacheLine.h"
+
+namespace
+{
+
+constexpr uint32_t c_spinsBeforeYield = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring indices must work across processes");
+
+void wait_turn(uint32_t& rSpins)
+{
+    if (++rSpins > c_spinsBeforeYield) { std::this_thread::yield(); }
+}
+
+/**
+ * Ring of m_depth frames in memory shared by the two processes. Same scheme as SpscChannel: each side owns one index,
+ * and the indices sit on their own cache lines.
+ */
+struct ShmLink : ShardLink
+{
+    struct Header
+    {
+        alignas(lineSize_t) std::atomic<uint64_t> m_head;
+        alignas(lineSize_t) std::atomic<uint64_t> m_tail;
+    };
+
+    ~ShmLink() override
+    {
+        if (m_pMapping != MAP_FAILED) { munmap(m_pMapping, m_mappingSize); }
+    }
+
+    void send(const uint8_t* pFrame) override
+    {
+        uint64_t tail = m_pHeader->m_tail.load(std::memory_order_relaxed);
+        uint32_t spins = 0;
+        while (tail - m_pHeader->m_head.load(std::memory_order_acquire) >= m_depth) { wait_turn(spins); }
+        std::memcpy(m_pFrames + (tail % m_depth) * m_frameSize, pFrame, m_frameSize);
+        m_pHeader->m_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    void receive(uint8_t* pFrame) override
+    {
+        uint64_t head = m_pHeader->m_head.load(std::memory_order_relaxed);
+        uint32_t spins = 0;
+        while (m_pHeader->m_tail.load(std::memory_order_acquire) == head) { wait_turn(spins); }
+        std::memcpy(pFrame, m_pFrames + (head % m_depth) * m_frameSize, m_frameSize);
+        m_pHeader->m_head.store(head + 1, std::memory_order_release);
+    }
+
+    void* m_pMapping{MAP_FAILED};
+    size_t m_mappingSize{0};
+    Header* m_pHeader{nullptr};
+    uint8_t* m_pFrames{nullptr};
+};
+
+bool write_all(int fd, const uint8_t* pData, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::send(fd, pData, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n <= 0) { return false; }
+        pData += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, uint8_t* pData, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::recv(fd, pData, size, 0);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n <= 0) { return false; }
+        pData += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+/**
+ * Frames go one way over a loopback TCP connection, and the reader answers each with one credit byte, so the writer
+ * never has more than m_depth frames unread no matter how big the kernel buffers are. Each process closes the ends it
+ * doesn't use (keep_ends), so a peer dying shows up as a closed connection. A lost peer means the run is over: the
+ * process exits rather than simulate on stale values.
+ */
+struct SocketLink : ShardLink
+{
+    ~SocketLink() override
+    {
+        if (m_sendFd >= 0) { close(m_sendFd); }
+        if (m_receiveFd >= 0) { close(m_receiveFd); }
+    }
+
+    void send(const uint8_t* pFrame) override
+    {
+        uint8_t credit;
+        if (m_inFlight == m_depth)
+        {
+            if (!read_all(m_sendFd, &credit, 1)) { fail(); }
+            m_inFlight--;
+        }
+        if (!write_all(m_sendFd, pFrame, m_frameSize)) { fail(); }
+        m_inFlight++;
+    }
+
+    void receive(uint8_t* pFrame) override
+    {
+        uint8_t credit = 0;
+        if (!read_all(m_receiveFd, pFrame, m_frameSize) || !write_all(m_receiveFd, &credit, 1)) { fail(); }
+    }
+
+    void keep_ends(bool sends, bool receives) override
+    {
+        if (!sends && m_sendFd >= 0)
+        {
+            close(m_sendFd);
+            m_sendFd = -1;
+        }
+        if (!receives && m_receiveFd >= 0)
+        {
+            close(m_receiveFd);
+            m_receiveFd = -1;
+        }
+    }
+
+    [[noreturn]] static void fail()
+    {
+        std::cerr << "SysShard: lost connection to peer shard: " << std::strerror(errno) << "\n";
+        _exit(1);
+    }
+
+    int m_sendFd{-1};
+    int m_receiveFd{-1};
+    uint32_t m_inFlight{0};
+};
+
+// Cut wires going from one part to another, in one frame per cycle.
+struct Stream
+{
+    uint32_t m_from;
+    uint32_t m_to;
+    std::vector<Connection*> m_wires;
+    std::unique_ptr<ShardLink> m_pLink;
+};
+
+size_t frame_size(const std::vector<Connection*>& wires)
+{
+    size_t size = 0;
+    for (const Connection* pWire : wires) { size += pWire->packed_size(); }
+    return size;
+}
+
+void pack_frame(const std::vector<Connection*>& wires, std::vector<uint8_t>& rFrame)
+{
+    uint8_t* pOut = rFrame.data();
+    for (const Connection* pWire : wires)
+    {
+        pWire->pack(pOut);
+        pOut += pWire->packed_size();
+    }
+}
+
+void unpack_frame(const std::vector<Connection*>& wires, const std::vector<uint8_t>& frame)
+{
+    const uint8_t* pIn = frame.data();
+    for (Connection* pWire : wires)
+    {
+        pWire->unpack(pIn);
+        pIn += pWire->packed_size();
+    }
+}
+
+std::unique_ptr<ShardLink> make_link(const ShardOptions& options, size_t frameSize, uint32_t depth)
+{
+    return (options.m_transport == ShardTransport::Socket)
+        ? SysShard::make_socket_link(frameSize, depth)
+        : SysShard::make_shm_link(frameSize, depth);
+}
+
+// The clock loop of one shard. Frame 0 of every stream is the initial value of its wires.
+void run_shard(CircuitData& rData, const std::vector<nodeID_t>& nodes, std::vector<Stream*>& rIncoming,
+    std::vector<Stream*>& rOutgoing, uint64_t cycles)
+{
+    std::vector<std::vector<uint8_t>> frames(rIncoming.size() + rOutgoing.size());
+    for (size_t i = 0; i < rIncoming.size(); i++) { frames[i].resize(rIncoming[i]->m_pLink->m_frameSize); }
+    for (size_t i = 0; i < rOutgoing.size(); i++)
+    {
+        std::vector<uint8_t>& rFrame = frames[rIncoming.size() + i];
+        rFrame.resize(rOutgoing[i]->m_pLink->m_frameSize);
+        if (cycles > 0)
+        {
+            pack_frame(rOutgoing[i]->m_wires, rFrame);
+            rOutgoing[i]->m_pLink->send(rFrame.data());
+        }
+    }
+
+    for (uint64_t clk = 0; clk < cycles; clk++)
+    {
+        for (size_t i = 0; i < rIncoming.size(); i++)
+        {
+            rIncoming[i]->m_pLink->receive(frames[i].data());
+            unpack_frame(rIncoming[i]->m_wires, frames[i]);
+        }
+        for (nodeID_t id : nodes) { rData.m_nodes[id]->process(rData); }
+        for (nodeID_t id : nodes) { rData.m_nodes[id]->propagate(rData); }
+        if (clk + 1 == cycles) { break; }
+        for (size_t i = 0; i < rOutgoing.size(); i++)
+        {
+            std::vector<uint8_t>& rFrame = frames[rIncoming.size() + i];
+            pack_frame(rOutgoing[i]->m_wires, rFrame);
+            rOutgoing[i]->m_pLink->send(rFrame.data());
+        }
+    }
+}
+
+// Releases every link end the given part doesn't use. Part 0 is the calling process, which also reads the results.
+void keep_own_ends(uint32_t part, std::vector<Stream>& rStreams, std::vector<Stream>& rResults)
+{
+    for (Stream& rStream : rStreams) { rStream.m_pLink->keep_ends(rStream.m_from == part, rStream.m_to == part); }
+    for (Stream& rStream : rResults) { rStream.m_pLink->keep_ends(rStream.m_from == part, rStream.m_to == part); }
+}
+
+} // namespace
+
+std::unique_ptr<ShardLink> SysShard::make_shm_link(size_t frameSize, uint32_t depth)
+{
+    auto link = std::make_unique<ShmLink>();
+    link->m_frameSize = frameSize;
+    link->m_depth = std::max(depth, 1u);
+
+    size_t headerSize = (sizeof(ShmLink::Header) + lineSize_t - 1) / lineSize_t * lineSize_t;
+    link->m_mappingSize = headerSize + std::max<size_t>(frameSize * link->m_depth, 1);
+    link->m_pMapping = mmap(nullptr, link->m_mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (link->m_pMapping == MAP_FAILED)
+    {
+        std::cerr << "SysShard: mmap failed: " << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+    link->m_pHeader = new (link->m_pMapping) ShmLink::Header{};
+    link->m_pFrames = static_cast<uint8_t*>(link->m_pMapping) + headerSize;
+    return link;
+}
+
+std::unique_ptr<ShardLink> SysShard::make_socket_link(size_t frameSize, uint32_t depth)
+{
+    auto link = std::make_unique<SocketLink>();
+    link->m_frameSize = frameSize;
+    link->m_depth = std::max(depth, 1u);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    bool ok = listener >= 0
+        && bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+        && listen(listener, 1) == 0
+        && getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0;
+    if (ok) { link->m_sendFd = socket(AF_INET, SOCK_STREAM, 0); }
+    ok = ok && link->m_sendFd >= 0
+        && connect(link->m_sendFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    if (ok) { link->m_receiveFd = accept(listener, nullptr, nullptr); }
+    ok = ok && link->m_receiveFd >= 0;
+    if (!ok) { std::cerr << "SysShard: loopback socket setup failed: " << std::strerror(errno) << "\n"; }
+    if (listener >= 0) { close(listener); }
+    if (!ok) { return nullptr; }
+
+    int one = 1;
+    setsockopt(link->m_sendFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(link->m_receiveFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return link;
+}
+
+bool SysShard::run(CircuitData& rData, const Partitioning& partitioning, uint64_t cycles, const ShardOptions& options)
+{
+    NetlistGraph graph = SysNetlist::build(rData);
+    uint32_t numParts = std::max(partitioning.m_numParts, 1u);
+
+    std::vector<std::vector<nodeID_t>> nodes(numParts);
+    for (nodeID_t id = 0; id < partitioning.m_part.size(); id++)
+    {
+        if (partitioning.m_part[id] != noneID_t) { nodes[partitioning.m_part[id]].push_back(id); }
+    }
+
+    // One stream per (driver part, reader part) pair, carrying the cut wires in m_cutWires order.
+    std::vector<Stream> streams;
+    std::map<std::pair<uint32_t, uint32_t>, size_t> streamOf;
+    for (edgeID_t wire : partitioning.m_cutWires)
+    {
+        Connection* pWire = rData.m_edges[wire].get();
+        if (pWire->packed_size() == 0)
+        {
+            std::cerr << "SysShard: cut wire " << wire << " can't be flattened\n";
+            return false;
+        }
+
+        uint32_t from = partitioning.m_part[graph.m_driver[wire]];
+        for (uint32_t r = graph.m_readerStart[wire]; r < graph.m_readerStart[wire + 1]; r++)
+        {
+            uint32_t to = partitioning.m_part[graph.m_readers[r]];
+            if (to == from) { continue; }
+            auto found = streamOf.emplace(std::make_pair(from, to), streams.size());
+            if (found.second) { streams.push_back(Stream{from, to, {}, nullptr}); }
+            std::vector<Connection*>& rWires = streams[found.first->second].m_wires;
+            if (rWires.empty() || rWires.back() != pWire) { rWires.push_back(pWire); }
+        }
+    }
+
+    // Every other shard hands the final values of the wires it drives back to part 0 the same way.
+    std::vector<Stream> results;
+    for (uint32_t part = 1; part < numParts; part++)
+    {
+        results.push_back(Stream{part, 0, {}, nullptr});
+        for (nodeID_t id : nodes[part])
+        {
+            for (uint32_t o = graph.m_outputStart[id]; o < graph.m_outputStart[id + 1]; o++)
+            {
+                Connection* pWire = rData.m_edges[graph.m_outputs[o]].get();
+                if (pWire->packed_size() > 0) { results.back().m_wires.push_back(pWire); }
+            }
+        }
+    }
+
+    for (Stream& rStream : streams)
+    {
+        rStream.m_pLink = make_link(options, frame_size(rStream.m_wires), options.m_lookahead);
+        if (!rStream.m_pLink) { return false; }
+    }
+    for (Stream& rStream : results)
+    {
+        rStream.m_pLink = make_link(options, frame_size(rStream.m_wires), 1);
+        if (!rStream.m_pLink) { return false; }
+    }
+
+    std::vector<std::vector<Stream*>> incoming(numParts), outgoing(numParts);
+    for (Stream& rStream : streams)
+    {
+        outgoing[rStream.m_from].push_back(&rStream);
+        incoming[rStream.m_to].push_back(&rStream);
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::vector<pid_t> children;
+    for (uint32_t part = 1; part < numParts; part++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            keep_own_ends(part, streams, results);
+            if (part < options.m_placement.m_workerCpus.size())
+            {
+                SysNuma::pin_current_thread(options.m_placement.m_workerCpus[part]);
+            }
+            run_shard(rData, nodes[part], incoming[part], outgoing[part], cycles);
+            if (options.m_onFinish) { options.m_onFinish(part, rData); }
+
+            Stream& rResult = results[part - 1];
+            std::vector<uint8_t> frame(rResult.m_pLink->m_frameSize);
+            pack_frame(rResult.m_wires, frame);
+            rResult.m_pLink->send(frame.data());
+            std::cout.flush();
+            _exit(0);
+        }
+        if (pid < 0)
+        {
+            std::cerr << "SysShard: fork failed: " << std::strerror(errno) << "\n";
+            for (pid_t child : children) { kill(child, SIGKILL); }
+            for (pid_t child : children) { waitpid(child, nullptr, 0); }
+            return false;
+        }
+        children.push_back(pid);
+    }
+
+    keep_own_ends(0, streams, results);
+
+    std::vector<uint32_t> callerCpus = SysNuma::thread_cpus();
+    if (!options.m_placement.m_workerCpus.empty()) { SysNuma::pin_current_thread(options.m_placement.m_workerCpus[0]); }
+    run_shard(rData, nodes[0], incoming[0], outgoing[0], cycles);
+    SysNuma::pin_current_thread(callerCpus);
+    if (options.m_onFinish) { options.m_onFinish(0, rData); }
+
+    // Over shared memory, a shard that dies mid-run stalls the ones waiting on its frames; over sockets they exit.
+    bool ok = true;
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        std::vector<uint8_t> frame(results[i].m_pLink->m_frameSize);
+        results[i].m_pLink->receive(frame.data());
+        unpack_frame(results[i].m_wires, frame);
+
+        int status = 0;
+        waitpid(children[i], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "SysShard: shard " << i + 1 << " failed\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Netlist.h"
+#include "Numa.h"
+#include "Partition.h"
+
+// MULTI-PROCESS SIMULATION
+
+/**
+ * One-way stream of fixed-size frames between two shard processes. At most m_depth frames may be in flight: send()
+ * blocks while the reader is that far behind, receive() blocks until the next frame arrives.
+ */
+struct ShardLink
+{
+    virtual ~ShardLink() = default;
+
+    virtual void send(const uint8_t* pFrame) = 0;
+    virtual void receive(uint8_t* pFrame) = 0;
+
+    // Called in each process after forking with whether it sends and receives on this link. Releases the unused ends,
+    // so that a process dying closes the link for its peer.
+    virtual void keep_ends(bool, bool) {}
+
+    size_t m_frameSize{0};
+    uint32_t m_depth{1};
+};
+
+enum class ShardTransport
+{
+    SharedMemory,   // ring of frames in a MAP_SHARED mapping, polled
+    Socket          // TCP connection over 127.0.0.1, with a credit byte per frame read
+};
+
+struct ShardOptions
+{
+    ShardTransport m_transport{ShardTransport::SharedMemory};
+
+    // Frames a shard may run ahead of a shard that reads from it. Every wire already carries a one-cycle register
+    // delay, so 1 is exact lock-step; more lets a shard with no wires coming back from its readers keep going while
+    // they catch up.
+    uint32_t m_lookahead{1};
+
+    // When set, each shard process pins itself to its part's CPUs before the first cycle. Pages a shard writes are
+    // copied on write, so its node state and wires end up on its own NUMA node.
+    NumaPlacement m_placement;
+
+    // Called in every shard's process once its last cycle is done, before its node state is lost with the process.
+    std::function<void(uint32_t part, CircuitData& rData)> m_onFinish;
+};
+
+namespace SysShard
+{
+/**
+ * Simulates each part of the partitioning in its own process for the given number of cycles. The calling process runs
+ * part 0 and forks one child per other part, each with a copy-on-write image of the circuit. Each clock, a shard reads
+ * the frame of cut wire values each of its drivers published at the end of the last cycle, runs process and propagate
+ * over its own nodes, then sends the cut wires it drives on to its readers. Wire values match a serial run.
+ *
+ * When it returns, every flattenable wire (Connection::packed_size() != 0) in rData holds its final value, whichever
+ * shard drove it; every cut wire has to be flattenable. Node state of parts other than 0 is only visible to
+ * options.m_onFinish. A shard that crashes stalls the others over shared memory; over sockets its peers see the link
+ * close and exit, the calling process included.
+ * Returns false, having reported why on std::cerr, if the transport can't be set up or a child fails.
+ */
+bool run(CircuitData& rData, const Partitioning& partitioning, uint64_t cycles, const ShardOptions& options = {});
+
+// Link factories. Both must be called before forking; each end is then used by one process only.
+std::unique_ptr<ShardLink> make_shm_link(size_t frameSize, uint32_t depth);
+std::unique_ptr<ShardLink> make_socket_link(size_t frameSize, uint32_t depth);
+}
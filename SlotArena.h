@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "GraphTypes.h"
+
+template<typename DATA_T> struct SlotArena;
+
+/**
+ * Unique ownership of one slot in a SlotArena. Moving it through a connection moves a pointer and an index, never the
+ * payload. The slot goes back to the arena when the last owner lets go.
+ */
+template<typename DATA_T>
+struct SlotRef
+{
+    SlotRef() = default;
+    SlotRef(SlotArena<DATA_T>* pArena, uint32_t index) : m_pArena(pArena), m_index(index) {}
+    SlotRef(SlotRef&& other) noexcept : m_pArena(other.m_pArena), m_index(other.m_index) { other.m_pArena = nullptr; }
+    SlotRef& operator=(SlotRef&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_pArena = other.m_pArena;
+            m_index = other.m_index;
+            other.m_pArena = nullptr;
+        }
+        return *this;
+    }
+    SlotRef(const SlotRef&) = delete;
+    SlotRef& operator=(const SlotRef&) = delete;
+    ~SlotRef() { reset(); }
+
+    explicit operator bool() const { return m_pArena != nullptr; }
+    DATA_T& operator*() const { return m_pArena->data(m_index); }
+    DATA_T* operator->() const { return &m_pArena->data(m_index); }
+
+    void reset()
+    {
+        if (m_pArena) { m_pArena->release(m_index); }
+        m_pArena = nullptr;
+    }
+
+    SlotArena<DATA_T>* m_pArena{nullptr};
+    uint32_t m_index{0};
+};
+
+/**
+ * Shared, read-only view of a slot, for fanout. Copies bump a reference count in the arena.
+ */
+template<typename DATA_T>
+struct SharedSlot
+{
+    SharedSlot() = default;
+    SharedSlot(SlotRef<DATA_T>&& ref) : m_pArena(ref.m_pArena), m_index(ref.m_index) { ref.m_pArena = nullptr; }
+    SharedSlot(const SharedSlot& other) : m_pArena(other.m_pArena), m_index(other.m_index)
+    {
+        if (m_pArena) { m_pArena->retain(m_index); }
+    }
+    SharedSlot(SharedSlot&& other) noexcept : m_pArena(other.m_pArena), m_index(other.m_index) { other.m_pArena = nullptr; }
+    SharedSlot& operator=(SharedSlot other) noexcept
+    {
+        std::swap(m_pArena, other.m_pArena);
+        std::swap(m_index, other.m_index);
+        return *this;
+    }
+    ~SharedSlot() { if (m_pArena) { m_pArena->release(m_index); } }
+
+    explicit operator bool() const { return m_pArena != nullptr; }
+    const DATA_T& operator*() const { return m_pArena->data(m_index); }
+    const DATA_T* operator->() const { return &m_pArena->data(m_index); }
+
+    SlotArena<DATA_T>* m_pArena{nullptr};
+    uint32_t m_index{0};
+};
+
+/**
+ * Fixed set of preallocated payload slots. Payloads are constructed once, up front, and reused; acquire() hands out an
+ * owning SlotRef, or an empty one if every slot is in flight. The arena must outlive every ref into it.
+ * Reference counts are plain integers: refs must only be moved and dropped on one thread at a time.
+ */
+template<typename DATA_T>
+struct SlotArena
+{
+    SlotArena(uint32_t capacity, const DATA_T& prototype = DATA_T{})
+        : m_data(capacity, prototype), m_refs(capacity, 0)
+    {
+        m_free.reserve(capacity);
+        for (uint32_t i = capacity; i > 0; i--) { m_free.push_back(i - 1); }
+    }
+
+    // Refs point back at the arena, so it stays where it was built.
+    SlotArena(const SlotArena&) = delete;
+    SlotArena& operator=(const SlotArena&) = delete;
+    SlotArena(SlotArena&&) = delete;
+    SlotArena& operator=(SlotArena&&) = delete;
+
+    SlotRef<DATA_T> acquire()
+    {
+        if (m_free.empty())
+        {
+            m_exhausted++;
+            return {};
+        }
+        uint32_t index = m_free.back();
+        m_free.pop_back();
+        m_refs[index] = 1;
+        return SlotRef<DATA_T>(this, index);
+    }
+
+    DATA_T& data(uint32_t index) { return m_data[index]; }
+
+    void retain(uint32_t index) { m_refs[index]++; }
+
+    void release(uint32_t index)
+    {
+        assert(m_refs[index] > 0);
+        if (--m_refs[index] == 0) { m_free.push_back(index); }
+    }
+
+    size_t in_flight() const { return m_data.size() - m_free.size(); }
+
+    std::vector<DATA_T> m_data;
+    std::vector<uint32_t> m_refs;
+    std::vector<uint32_t> m_free;
+    size_t m_exhausted{0};
+};
+
+/**
+ * Hands one SlotRef from the source to every sink as a SharedSlot. The payload is never copied; each sink just holds a
+ * reference until it takes its next input.
+ */
+template<typename SOURCE_T, typename ... SINKS_T>
+struct SharedFanoutConnection : IConnection
+{
+    SharedFanoutConnection(std::shared_ptr<SOURCE_T> src, std::shared_ptr<SINKS_T> ... sinks)
+        : source(src), m_sinks(std::move(sinks)...)
+    {}
+
+    void distribute() override final
+    {
+        auto shared = make_shared_slot(source->return_output());
+        std::apply([&shared](auto& ... sink) { (sink->accept_input(shared), ...); }, m_sinks);
+    }
+
+    template<typename DATA_T>
+    static SharedSlot<DATA_T> make_shared_slot(SlotRef<DATA_T>&& ref) { return SharedSlot<DATA_T>(std::move(ref)); }
+
+    std::shared_ptr<SOURCE_T> source;
+    std::tuple<std::shared_ptr<SINKS_T>...> m_sinks;
+};
@@ -0,0 +1,70 @@
+#include "Staging.h"
+
+#include <thread>
+
+namespace
+{
+
+void move_stage(CircuitData& rData, CircuitStage& rStage, const StagePlacement& placement)
+{
+    CircuitData& rLocal = rStage.m_data;
+    auto rewire = [&](edgeID_t& rWire, bool)
+    {
+        if (rWire & importedWire_t) { rWire = rStage.m_imported[rWire & ~importedWire_t]; }
+        else if (rWire < rLocal.m_edges.size()) { rWire = placement.wire(rWire); }
+    };
+
+    for (nodeID_t local = 1; local < rLocal.m_nodes.size(); local++)
+    {
+        std::shared_ptr<Node>& rNode = rLocal.m_nodes[local];
+        if (rNode) { rNode->terminals(rewire); }
+        rData.m_nodes[placement.node(local)] = std::move(rNode);
+    }
+    for (edgeID_t local = 1; local < rLocal.m_edges.size(); local++)
+    {
+        std::shared_ptr<Connection>& rWire = rLocal.m_edges[local];
+        if (rWire)
+        {
+            rWire->m_in = placement.node(rWire->m_in);
+            rWire->m_out = placement.node(rWire->m_out);
+        }
+        rData.m_edges[placement.wire(local)] = std::move(rWire);
+    }
+    rStage = CircuitStage{};
+}
+
+} // namespace
+
+edgeID_t SysStage::import(CircuitStage& rStage, edgeID_t targetWire)
+{
+    rStage.m_imported.push_back(targetWire);
+    return importedWire_t | edgeID_t(rStage.m_imported.size() - 1);
+}
+
+std::vector<StagePlacement> SysStage::merge(CircuitData& rData, std::vector<CircuitStage>& rStages)
+{
+    std::vector<StagePlacement> result;
+    size_t numNodes = rData.m_nodes.size();
+    size_t numWires = rData.m_edges.size();
+    for (const CircuitStage& stage : rStages)
+    {
+        StagePlacement placement;
+        placement.m_nodes = IdRange{nodeID_t(numNodes), nodeID_t(stage.m_data.m_nodes.size() - 1)};
+        placement.m_wires = IdRange{edgeID_t(numWires), edgeID_t(stage.m_data.m_edges.size() - 1)};
+        numNodes = placement.m_nodes.end();
+        numWires = placement.m_wires.end();
+        result.push_back(placement);
+    }
+    rData.m_nodes.resize(numNodes);
+    rData.m_edges.resize(numWires);
+
+    // Slots are allocated up front and every stage writes its own, so the stages can move in concurrently.
+    std::vector<std::thread> threads;
+    for (size_t s = 1; s < rStages.size(); s++)
+    {
+        threads.emplace_back([&rData, &rStages, &result, s]() { move_stage(rData, rStages[s], result[s]); });
+    }
+    if (!rStages.empty()) { move_stage(rData, rStages[0], result[0]); }
+    for (std::thread& thread : threads) { thread.join(); }
+    return result;
+}
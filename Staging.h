@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Nodes.h"
+
+// PARALLEL CONSTRUCTION
+
+// Wire IDs with this bit set name an entry of CircuitStage::m_imported rather than one of the stage's own wires.
+constexpr edgeID_t importedWire_t = edgeID_t(1) << 31;
+
+/**
+ * A piece of circuit built apart from the circuit it will join, so that several threads can build at once, one stage
+ * each. Build into m_data with the usual add/connect calls; its IDs are local to the stage. Wires that already exist in
+ * the target circuit (shared inputs, clocks) are reached through SysStage::import(). A stage isn't runnable on its own.
+ */
+struct CircuitStage
+{
+    CircuitData m_data;
+    std::vector<edgeID_t> m_imported;       // target wire IDs, indexed by local ID & ~importedWire_t
+};
+
+// Where a stage's nodes and wires ended up after SysStage::merge.
+struct StagePlacement
+{
+    nodeID_t node(nodeID_t local) const { return local == nullNode_t ? nullNode_t : m_nodes.m_first + local - 1; }
+    edgeID_t wire(edgeID_t local) const { return local == nullEdge_t ? nullEdge_t : m_wires.m_first + local - 1; }
+
+    IdRange m_nodes;
+    IdRange m_wires;
+};
+
+namespace SysStage
+{
+/**
+ * Local ID under which stage terminals can use the target's wire. Assign it to terminal m_id directly; connect() always
+ * makes a new wire. The target wire's m_in/m_out aren't updated by merge().
+ */
+edgeID_t import(CircuitStage& rStage, edgeID_t targetWire);
+
+/**
+ * Appends the stages to rData in order, one thread per stage, renumbering terminals (through Node::terminals()) and
+ * wire endpoints. The result is the circuit serial construction would give when building the stages one after another.
+ * NodeTerminal::m_parentID isn't visible to the pass and keeps its local value. Leaves the stages empty.
+ */
+std::vector<StagePlacement> merge(CircuitData& rData, std::vector<CircuitStage>& rStages);
+}
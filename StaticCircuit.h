@@ -0,0 +1,197 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "Nodes.h"
+
+// COMPILE-TIME CIRCUITS
+
+/**
+ * Circuits whose topology is a type. Every gate is a struct with a static constexpr eval(), so the
+ * compiler sees the whole netlist at once: a sub-circuit inlines down to its boolean expression, and a
+ * circuit that only depends on constants and ROMs can be evaluated entirely at compile time.
+ *
+ *     using Rom16 = StaticCircuit::Rom<uint32_t, 0, 1, 2, 3>;
+ *     using Sum   = StaticCircuit::Xor<StaticCircuit::In<0>, StaticCircuit::RomAt<Rom16>>;
+ *     static_assert(StaticCircuit::trace<Sum, 8>(StaticCircuit::Env<uint32_t, 1>{{5}})[2] == 7);
+ *
+ * And/Or/Xor use the bitwise &, |, ^ for every type, bool included (no short-circuiting; on bool the result is the
+ * logical one). Not is ! on bool and ~ on other integral types.
+ */
+namespace StaticCircuit
+{
+
+// Values seen by a circuit: its inputs, and the clock for ROM-driven parts.
+template <typename DATA_T, size_t N_IN>
+struct Env
+{
+    std::array<DATA_T, N_IN> m_inputs{};
+    uint64_t m_cycle{0};
+};
+
+template <typename T>
+constexpr T invert(T value)
+{
+    if constexpr (std::is_same_v<T, bool>) { return !value; }
+    else { return static_cast<T>(~value); }
+}
+
+template <size_t I>
+struct In
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env) { return env.m_inputs[I]; }
+};
+
+template <auto VALUE>
+struct Lit
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T&) { return VALUE; }
+};
+
+template <typename A, typename B>
+struct And
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env)
+    {
+        auto a = A::eval(env);
+        return static_cast<decltype(a)>(a & B::eval(env));
+    }
+};
+
+template <typename A, typename B>
+struct Or
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env)
+    {
+        auto a = A::eval(env);
+        return static_cast<decltype(a)>(a | B::eval(env));
+    }
+};
+
+template <typename A, typename B>
+struct Xor
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env)
+    {
+        auto a = A::eval(env);
+        return static_cast<decltype(a)>(a ^ B::eval(env));
+    }
+};
+
+template <typename A>
+struct Not
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env) { return invert(A::eval(env)); }
+};
+
+template <typename A, typename B> using Nand = Not<And<A, B>>;
+template <typename A, typename B> using Nor = Not<Or<A, B>>;
+
+// SEL ? A : B. Only the selected side is evaluated.
+template <typename SEL, typename A, typename B>
+struct Mux
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env) { return SEL::eval(env) ? A::eval(env) : B::eval(env); }
+};
+
+template <typename DATA_T, DATA_T ... DATA>
+struct Rom
+{
+    static_assert(sizeof...(DATA) > 0, "a Rom needs at least one word");
+
+    static constexpr std::array<DATA_T, sizeof...(DATA)> s_data{DATA...};
+
+    static constexpr DATA_T at(uint64_t addr) { return s_data[addr % sizeof...(DATA)]; }
+};
+
+// ROM word addressed by an expression.
+template <typename ROM_T, typename ADDR>
+struct RomRead
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env) { return ROM_T::at(uint64_t(ADDR::eval(env))); }
+};
+
+// ROM stepping one word per cycle, like the ROM node's program counter.
+template <typename ROM_T>
+struct RomAt
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env) { return ROM_T::at(env.m_cycle); }
+};
+
+// Several outputs over the same inputs. All outputs must have the same type.
+template <typename ... OUTS>
+struct Circuit
+{
+    template <typename ENV_T>
+    static constexpr auto eval(const ENV_T& env)
+    {
+        using value_t = std::common_type_t<decltype(OUTS::eval(env))...>;
+        return std::array<value_t, sizeof...(OUTS)>{value_t(OUTS::eval(env))...};
+    }
+};
+
+// Output of the circuit for each of the first CYCLES clocks, with the inputs held constant.
+template <typename CIRCUIT_T, size_t CYCLES, typename ENV_T>
+constexpr auto trace(ENV_T env)
+{
+    std::array<decltype(CIRCUIT_T::eval(env)), CYCLES> out{};
+    for (size_t clk = 0; clk < CYCLES; clk++)
+    {
+        env.m_cycle = clk;
+        out[clk] = CIRCUIT_T::eval(env);
+    }
+    return out;
+}
+
+// Number of gates in the expression tree (shared sub-expressions counted per use).
+template <typename T> struct GateCount { static constexpr size_t value = 0; };
+template <typename A, typename B> struct GateCount<And<A, B>> { static constexpr size_t value = 1 + GateCount<A>::value + GateCount<B>::value; };
+template <typename A, typename B> struct GateCount<Or<A, B>> { static constexpr size_t value = 1 + GateCount<A>::value + GateCount<B>::value; };
+template <typename A, typename B> struct GateCount<Xor<A, B>> { static constexpr size_t value = 1 + GateCount<A>::value + GateCount<B>::value; };
+template <typename A> struct GateCount<Not<A>> { static constexpr size_t value = 1 + GateCount<A>::value; };
+template <typename S, typename A, typename B> struct GateCount<Mux<S, A, B>> { static constexpr size_t value = 1 + GateCount<S>::value + GateCount<A>::value + GateCount<B>::value; };
+template <typename R, typename A> struct GateCount<RomRead<R, A>> { static constexpr size_t value = 1 + GateCount<A>::value; };
+
+}
+
+// Drops a compile-time circuit into a CircuitData as a single node. Single-output circuits only: a multi-output
+// Circuit<> evaluates to an array, which has no wire to go on.
+template <typename CIRCUIT_T, typename DATA_T, size_t N_IN>
+struct StaticNode : public Node
+{
+    void process(CircuitData& rData) override
+    {
+        StaticCircuit::Env<DATA_T, N_IN> env;
+        for (size_t i = 0; i < N_IN; i++) { env.m_inputs[i] = m_inputs[i].get(rData).m_value; }
+        env.m_cycle = m_cycle;
+        m_outVal = CIRCUIT_T::eval(env);
+    }
+
+    void propagate(CircuitData& rData) override
+    {
+        m_output.get(rData).m_value = m_outVal;
+        m_cycle++;
+    }
+
+    void terminals(const TerminalVisitor& visit) override
+    {
+        for (auto& input : m_inputs) { visit(input.m_id, false); }
+        visit(m_output.m_id, true);
+    }
+
+    std::array<NodeTerminal<WireNode<DATA_T>>, N_IN> m_inputs;
+    NodeTerminal<WireNode<DATA_T>> m_output;
+
+    DATA_T m_outVal{};
+    uint64_t m_cycle{0};
+};